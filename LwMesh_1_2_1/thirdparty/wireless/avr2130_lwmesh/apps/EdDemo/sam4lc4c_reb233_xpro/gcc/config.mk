@@ -78,9 +78,12 @@ CSRCS = \
        thirdparty/wireless/avr2130_lwmesh/apps/EdDemo/EdDemo.c \
        thirdparty/wireless/avr2130_lwmesh/source/nwk/src/nwk.c \
        thirdparty/wireless/avr2130_lwmesh/source/nwk/src/nwkDataReq.c \
+       thirdparty/wireless/avr2130_lwmesh/source/nwk/src/nwkFrag.c \
+       thirdparty/wireless/avr2130_lwmesh/source/nwk/src/nwkStream.c \
        thirdparty/wireless/avr2130_lwmesh/source/nwk/src/nwkFrame.c \
        thirdparty/wireless/avr2130_lwmesh/source/nwk/src/nwkGroup.c \
        thirdparty/wireless/avr2130_lwmesh/source/nwk/src/nwkRoute.c \
+       thirdparty/wireless/avr2130_lwmesh/source/nwk/src/nwkNeighbour.c \
        thirdparty/wireless/avr2130_lwmesh/source/nwk/src/nwkRouteDiscovery.c \
        thirdparty/wireless/avr2130_lwmesh/source/nwk/src/nwkRx.c \
        thirdparty/wireless/avr2130_lwmesh/source/nwk/src/nwkSecurity.c \
@@ -38,6 +38,7 @@
 #include "config.h"
 #include "phy.h"
 #include "sys.h"
+#include "sysTimer.h"
 #include "nwk.h"
 #include "tester.h"
 #include "filter.h"
@@ -116,6 +117,28 @@ static void appCommandsSendRouteEntry(uint16_t index,
 
 #endif
 
+/*************************************************************************//**
+*****************************************************************************/
+#ifdef NWK_ENABLE_NEIGHBOUR_TABLE
+static void appCommandsSendNeighbourEntry(NWK_NeighbourEntry_t *entry)
+{
+	AppCommandNeighbourEntry_t cmd;
+
+	cmd.id          = APP_COMMAND_NEIGHBOUR_ENTRY;
+	cmd.addr        = entry->addr;
+	cmd.lqi         = entry->lqi;
+	cmd.rssi        = entry->rssi;
+	cmd.txAttempts  = entry->txAttempts;
+	cmd.txSuccesses = entry->txSuccesses;
+	cmd.etx         = NWK_NeighbourEtx(entry->addr);
+	cmd.rtt         = entry->rtt;
+	cmd.age         = SYS_TimerTime() - entry->lastHeard;
+
+	appUartSendCommand((uint8_t *)&cmd, sizeof(cmd));
+}
+
+#endif
+
 /*************************************************************************//**
 *****************************************************************************/
 static void appCommandsSendDataInd(NWK_DataInd_t *ind)
@@ -431,10 +454,21 @@ AppStatus_t appCommandReceived(uint8_t *buf, uint16_t size)
 	{
 		NWK_RouteTableEntry_t *entry;
 
-		entry = NWK_RouteNewEntry();
+		entry = NWK_RouteFindEntry(cmd->routeAdd.dstAddr,
+				cmd->routeAdd.multicast);
+
+		if (NULL == entry) {
+			entry = NWK_RouteNewEntry();
+
+			if (NULL == entry) {
+				return APP_STATUS_TABLE_IS_FULL;
+			}
+
+			entry->multicast = cmd->routeAdd.multicast;
+			entry->dstAddr   = cmd->routeAdd.dstAddr;
+		}
+
 		entry->fixed       = cmd->routeAdd.fixed;
-		entry->multicast   = cmd->routeAdd.multicast;
-		entry->dstAddr     = cmd->routeAdd.dstAddr;
 		entry->nextHopAddr = cmd->routeAdd.nextHopAddr;
 		entry->lqi         = cmd->routeAdd.lqi;
 	}
@@ -508,6 +542,30 @@ AppStatus_t appCommandReceived(uint8_t *buf, uint16_t size)
 	break;
 #endif
 
+#ifdef NWK_ENABLE_NEIGHBOUR_TABLE
+	case APP_COMMAND_NEIGHBOUR_FLUSH:
+	{
+		NWK_NeighbourEntry_t *entry, *next;
+
+		for (entry = NWK_NeighbourFirst(); entry; entry = next) {
+			next = NWK_NeighbourNext(entry);
+			NWK_NeighbourRemove(entry);
+		}
+	}
+	break;
+
+	case APP_COMMAND_NEIGHBOUR_TABLE:
+	{
+		NWK_NeighbourEntry_t *entry;
+
+		for (entry = NWK_NeighbourFirst(); entry;
+				entry = NWK_NeighbourNext(entry)) {
+			appCommandsSendNeighbourEntry(entry);
+		}
+	}
+	break;
+#endif
+
 	default:
 		return APP_STATUS_UNKNOWN_COMMAND;
 	}
@@ -73,6 +73,10 @@ typedef enum AppCommandId_t {
 
 	APP_COMMAND_FILTER_ADD       = 0x71,
 	APP_COMMAND_FILTER_REMOVE    = 0x72,
+
+	APP_COMMAND_NEIGHBOUR_FLUSH  = 0x80,
+	APP_COMMAND_NEIGHBOUR_TABLE  = 0x81,
+	APP_COMMAND_NEIGHBOUR_ENTRY  = 0x82,
 } AppCommandId_t;
 
 COMPILER_PACK_SET(1)
@@ -255,6 +259,26 @@ typedef struct {
 	uint16_t addr;
 } AppCommandFilterRemove_t;
 
+typedef struct {
+	uint8_t id;
+} AppCommandNeighbourFlush_t;
+
+typedef struct {
+	uint8_t id;
+} AppCommandNeighbourTable_t;
+
+typedef struct {
+	uint8_t id;
+	uint16_t addr;
+	uint8_t lqi;
+	int8_t rssi;
+	uint16_t txAttempts;
+	uint16_t txSuccesses;
+	uint16_t etx;
+	uint16_t rtt;
+	uint32_t age;
+} AppCommandNeighbourEntry_t;
+
 typedef union {
 	AppCommandHeader_t header;
 	AppCommandDummy_t dummy;
@@ -294,6 +318,11 @@ typedef union {
 	AppCommandFilterAdd_t filterAdd;
 	AppCommandFilterRemove_t filterRemove;
 #endif
+
+#ifdef NWK_ENABLE_NEIGHBOUR_TABLE
+	AppCommandNeighbourFlush_t neighbourFlush;
+	AppCommandNeighbourTable_t neighbourTable;
+#endif
 } AppReceiveCommand_t;
 COMPILER_PACK_RESET()
 /*- Prototypes -------------------------------------------------------------*/
@@ -12,3 +12,4 @@
 #define NWK_ENABLE_ROUTE_DISCOVERY
 #define NWK_ACK_WAIT_TIME 1000
 #define NWK_ENABLE_ROUTING
+#define NWK_ENABLE_NEIGHBOUR_TABLE
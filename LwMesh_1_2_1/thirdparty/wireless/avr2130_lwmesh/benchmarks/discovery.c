@@ -0,0 +1,121 @@
+/**
+ * \file discovery.c
+ *
+ * \brief Route discovery cost and latency versus the network size
+ *
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ *
+ */
+
+/*
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+/*- Includes ---------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "net.h"
+
+/*- Definitions ------------------------------------------------------------*/
+#define DISCOVERIES                20
+#define DISCOVERY_INTERVAL         4000 /* ms */
+#define PAYLOAD_SIZE               20
+
+/*- Variables --------------------------------------------------------------*/
+static const uint16_t sizes[][2] = {{50, 7}, {100, 10}, {200, 14}, {500, 22}};
+static uint16_t destination;
+static uint32_t tag, sentTime, latency, delivered;
+
+/*- Implementations --------------------------------------------------------*/
+
+/*************************************************************************//**
+*****************************************************************************/
+static void dataInd(uint16_t node, uint16_t src, uint16_t size,
+		uint32_t ind)
+{
+	if (ind == tag && node == destination) {
+		latency += netTime() - sentTime;
+		delivered++;
+		tag = 0;
+	}
+}
+
+/*************************************************************************//**
+*  @brief Sends DISCOVERIES messages between random nodes of grids of
+*  growing size, one at a time, so every message needs a route discovery.
+*  Nodes up to 1.5 grid steps apart hear each other reliably, the delivery
+*  ratio then falls to zero at 2 steps.
+*****************************************************************************/
+int main(int argc, char *argv[])
+{
+	char library[256];
+
+	snprintf(library, sizeof(library), "%s.so", argv[0]);
+
+	for (unsigned s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+		uint16_t amount = sizes[s][0];
+		uint32_t broadcasts = 0;
+
+		latency = 0;
+		delivered = 0;
+
+		netInit(library, amount, 1);
+		netSetHandlers(dataInd, NULL);
+		netPlaceGrid(sizes[s][1], 1.0);
+		netSetRange(1.5, 2.0);
+		netRun(DISCOVERY_INTERVAL);
+
+		for (uint32_t i = 1; i <= DISCOVERIES; i++) {
+			uint16_t node = rand() % amount;
+
+			do {
+				destination = rand() % amount;
+			} while (destination == node);
+
+			tag = i;
+			sentTime = netTime();
+			netSend(node, netAddr(destination), PAYLOAD_SIZE, 0, i);
+			netRun(DISCOVERY_INTERVAL);
+		}
+
+		broadcasts = netStats()->broadcasts;
+
+		printf("%u nodes: %.1f route requests and %.1f transmissions "
+				"per discovery, %.0f ms latency, %u of %u "
+				"delivered\n", amount,
+				(double)broadcasts / DISCOVERIES,
+				(double)netStats()->transmissions / DISCOVERIES,
+				delivered ? (double)latency / delivered : 0.0,
+				delivered, DISCOVERIES);
+
+		netClose();
+	}
+
+	return 0;
+}
@@ -0,0 +1,125 @@
+/**
+ * \file duplicates.c
+ *
+ * \brief Duplicate rejection cost and false drops against the number of sources
+ *
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ *
+ */
+
+/*
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/*- Includes ---------------------------------------------------------------*/
+#include <stdio.h>
+#include "sysConfig.h"
+#include "nwk.h"
+#include "bench.h"
+
+/*- Definitions ------------------------------------------------------------*/
+#ifndef BENCH_SOURCES
+#define BENCH_SOURCES              10
+#endif
+
+#define FRAMES                     20000
+#define PAYLOAD_SIZE               16
+
+/*- Variables --------------------------------------------------------------*/
+static uint8_t frame[BENCH_MAX_FRAME_SIZE];
+static uint8_t seq[BENCH_SOURCES];
+static uint32_t indicated;
+
+/*- Implementations --------------------------------------------------------*/
+
+/*************************************************************************//**
+*****************************************************************************/
+static bool dataInd(NWK_DataInd_t *ind)
+{
+	indicated++;
+	return true;
+}
+
+/*************************************************************************//**
+*  @brief Passes the frame to the stack and runs the main loop until it is
+*  handled
+*  @return @c true if the frame was indicated to the application
+*****************************************************************************/
+static bool receive(uint8_t size)
+{
+	uint32_t before = indicated;
+
+	benchPhyReceive(frame, size, 0xff);
+
+	while (NWK_Busy()) {
+		NWK_TaskHandler();
+	}
+
+	return indicated != before;
+}
+
+/*************************************************************************//**
+*  @brief Receives one frame every ms from BENCH_SOURCES sources in turn,
+*  each immediately followed by a copy of itself. A lost original is a
+*  false drop, an indicated copy is a missed duplicate.
+*****************************************************************************/
+int main(void)
+{
+	uint32_t dropped = 0, missed = 0;
+	uint64_t time = 0;
+
+	benchInit(0x0001);
+	NWK_OpenEndpoint(1, dataInd);
+
+	for (uint32_t i = 0; i < FRAMES; i++) {
+		uint16_t source = i % BENCH_SOURCES;
+		uint8_t size = benchDataFrame(frame, 0x0002 + source, 0x0001,
+				seq[source]++, false, PAYLOAD_SIZE);
+		uint64_t start = benchClock();
+
+		if (!receive(size)) {
+			dropped++;
+		}
+
+		if (receive(size)) {
+			missed++;
+		}
+
+		time += benchClock() - start;
+		benchAdvance(1);
+	}
+
+	printf("sources %3d   %6.1f ns/frame   %5.1f%% false drops   "
+			"%5.1f%% duplicates missed\n", BENCH_SOURCES,
+			(double)time / (2 * FRAMES), 100.0 * dropped / FRAMES,
+			100.0 * missed / FRAMES);
+
+	return 0;
+}
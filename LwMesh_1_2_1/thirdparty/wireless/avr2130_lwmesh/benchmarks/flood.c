@@ -0,0 +1,102 @@
+/**
+ * \file flood.c
+ *
+ * \brief Transmissions per network-wide broadcast in a 200 node grid
+ *
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ *
+ */
+
+/*
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/*- Includes ---------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "net.h"
+
+/*- Definitions ------------------------------------------------------------*/
+#define NODES_AMOUNT               200
+#define COLUMNS                    20
+#define FLOODS                     20
+#define FLOOD_INTERVAL             2000 /* ms */
+#define PAYLOAD_SIZE               20
+
+/*- Variables --------------------------------------------------------------*/
+static uint32_t received;
+static const float ranges[][2] = {{1.5, 2.5}, {2.3, 3.3}};
+
+/*- Implementations --------------------------------------------------------*/
+
+/*************************************************************************//**
+*****************************************************************************/
+static void dataInd(uint16_t node, uint16_t src, uint16_t size, uint32_t tag)
+{
+	received++;
+}
+
+/*************************************************************************//**
+*  @brief Sends FLOODS broadcasts from random nodes of a 20 x 10 grid, once
+*  for each of the ranges. Nodes up to the first distance (in grid steps)
+*  apart hear each other reliably, the delivery ratio then falls to zero at
+*  the second distance.
+*****************************************************************************/
+int main(int argc, char *argv[])
+{
+	char library[256];
+
+	snprintf(library, sizeof(library), "%s.so", argv[0]);
+
+	for (unsigned r = 0; r < sizeof(ranges) / sizeof(ranges[0]); r++) {
+		received = 0;
+		netInit(library, NODES_AMOUNT, 1);
+		netSetHandlers(dataInd, NULL);
+		netPlaceGrid(COLUMNS, 1.0);
+		netSetRange(ranges[r][0], ranges[r][1]);
+		netRun(FLOOD_INTERVAL);
+
+		for (int i = 0; i < FLOODS; i++) {
+			netSend(rand() % NODES_AMOUNT, 0xffff, PAYLOAD_SIZE, 0, i);
+			netRun(FLOOD_INTERVAL);
+		}
+
+		printf("range %.1f-%.1f: %.1f transmissions per flood, "
+				"%.1f%% of the nodes reached, %.1f collisions\n",
+				ranges[r][0], ranges[r][1],
+				(double)netStats()->transmissions / FLOODS,
+				100.0 * received / FLOODS / (NODES_AMOUNT - 1),
+				(double)netStats()->collisions / FLOODS);
+
+		netClose();
+	}
+
+	return 0;
+}
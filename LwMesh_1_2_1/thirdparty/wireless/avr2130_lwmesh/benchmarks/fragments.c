@@ -0,0 +1,174 @@
+/**
+ * \file fragments.c
+ *
+ * \brief 4 KB transfer time over one and three hops
+ *
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ *
+ */
+
+/*
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/*- Includes ---------------------------------------------------------------*/
+#include <stdio.h>
+#include "nwk.h"
+#include "net.h"
+
+/*- Definitions ------------------------------------------------------------*/
+#define NODES_AMOUNT               4
+#define TRANSFERS                  10
+#define TRANSFER_SIZE              4096
+#define TIMEOUT                    60000 /* ms */
+
+/*- Variables --------------------------------------------------------------*/
+static uint32_t received;
+static bool confirmed;
+static uint8_t status;
+
+/*- Implementations --------------------------------------------------------*/
+
+/*************************************************************************//**
+*****************************************************************************/
+static void dataInd(uint16_t node, uint16_t src, uint16_t size, uint32_t tag)
+{
+	if (tag) {
+		received += size;
+	}
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static void dataConf(uint16_t node, uint32_t tag, uint8_t conf)
+{
+	confirmed = true;
+	status = conf;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static bool waitConf(void)
+{
+	uint32_t start = netTime();
+
+	while (!confirmed && netTime() - start < TIMEOUT) {
+		netRun(1);
+	}
+
+	confirmed = false;
+	return NWK_SUCCESS_STATUS == status;
+}
+
+/*************************************************************************//**
+*  @brief Sends one transfer from node 0 to node @a dst, with the
+*  fragmentation service if it is built in, otherwise as a sequence of
+*  acknowledged data requests
+*****************************************************************************/
+static bool transfer(uint16_t dst, uint32_t tag)
+{
+	if (netSendLarge(0, netAddr(dst), TRANSFER_SIZE, tag)) {
+		return waitConf();
+	}
+
+	for (uint16_t sent = 0; sent < TRANSFER_SIZE;) {
+		uint8_t size = NWK_MAX_PAYLOAD_SIZE;
+
+		if (TRANSFER_SIZE - sent < size) {
+			size = TRANSFER_SIZE - sent;
+		}
+
+		netSend(0, netAddr(dst), size, NWK_OPT_ACK_REQUEST, tag);
+
+		if (!waitConf()) {
+			return false;
+		}
+
+		sent += size;
+	}
+
+	return true;
+}
+
+/*************************************************************************//**
+*  @brief Sends TRANSFERS blocks of TRANSFER_SIZE bytes along a line of
+*  nodes where only the direct neighbours hear each other. The route is
+*  learned by a short exchange before the transfers are timed.
+*****************************************************************************/
+int main(int argc, char *argv[])
+{
+	static const uint16_t hops[] = {1, 3};
+	char library[256];
+
+	snprintf(library, sizeof(library), "%s.so", argv[0]);
+
+	for (unsigned h = 0; h < sizeof(hops) / sizeof(hops[0]); h++) {
+		uint16_t dst = hops[h];
+		uint32_t failed = 0;
+		uint32_t start, transmissions;
+
+		netInit(library, NODES_AMOUNT, 1);
+		netSetHandlers(dataInd, dataConf);
+
+		for (uint16_t i = 0; i < NODES_AMOUNT; i++) {
+			netPlace(i, i, 0);
+		}
+
+		netSetRange(1.0, 1.5);
+
+		netSend(0, netAddr(dst), 8, NWK_OPT_ACK_REQUEST, 0);
+		waitConf();
+		netSend(dst, netAddr(0), 8, NWK_OPT_ACK_REQUEST, 0);
+		waitConf();
+		netRun(100);
+
+		received = 0;
+		start = netTime();
+		transmissions = netStats()->transmissions;
+
+		for (uint32_t i = 0; i < TRANSFERS; i++) {
+			if (!transfer(dst, i + 1)) {
+				failed++;
+			}
+		}
+
+		printf("%u hop%s: %.0f ms per transfer, %.1f kbit/s, "
+				"%.1f transmissions per transfer, %u failed\n",
+				dst, dst > 1 ? "s" : "",
+				(double)(netTime() - start) / TRANSFERS,
+				8.0 * received / (netTime() - start),
+				(double)(netStats()->transmissions - transmissions) /
+				TRANSFERS, failed);
+
+		netClose();
+	}
+
+	return 0;
+}
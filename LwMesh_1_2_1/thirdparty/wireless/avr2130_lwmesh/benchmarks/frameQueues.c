@@ -0,0 +1,133 @@
+/**
+ * \file frameQueues.c
+ *
+ * \brief Main loop cost against the number of frame buffers
+ *
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ *
+ */
+
+/*
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/*- Includes ---------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "sysConfig.h"
+#include "nwk.h"
+#include "bench.h"
+
+/*- Definitions ------------------------------------------------------------*/
+#define PASSES                     1000000
+
+/*- Variables --------------------------------------------------------------*/
+static NWK_DataReq_t requests[NWK_BUFFERS_AMOUNT];
+static uint8_t payload[16];
+static uint8_t frame[BENCH_MAX_FRAME_SIZE];
+
+/*- Implementations --------------------------------------------------------*/
+
+/*************************************************************************//**
+*  @brief Returns the best of BENCH_RUNS averages of one main loop pass, ns
+*****************************************************************************/
+static double measurePass(void)
+{
+	double best = 0;
+
+	for (int run = 0; run < BENCH_RUNS; run++) {
+		uint64_t start = benchClock();
+
+		for (int i = 0; i < PASSES; i++) {
+			NWK_TaskHandler();
+		}
+
+		double ns = (double)(benchClock() - start) / PASSES;
+
+		if (0 == run || ns < best) {
+			best = ns;
+		}
+	}
+
+	return best;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static void dataConf(NWK_DataReq_t *req)
+{
+	(void)req;
+}
+
+/*************************************************************************//**
+*  @brief Measures an idle pool and a pool where every buffer holds a frame
+*  waiting for the transceiver, which never confirms. The frames are either
+*  broadcasts received for forwarding or local data requests.
+*****************************************************************************/
+int main(void)
+{
+	double idle, forward, local;
+
+	benchInit(0x0001);
+	idle = measurePass();
+
+	for (int i = 0; i < NWK_BUFFERS_AMOUNT; i++) {
+		uint8_t size = benchDataFrame(frame, 0x0002, NWK_BROADCAST_ADDR,
+				i, false, sizeof(payload));
+
+		benchPhyReceive(frame, size, 0xff);
+		benchAdvance(1);
+	}
+
+	benchAdvance(100);
+	forward = measurePass();
+
+	benchInit(0x0001);
+
+	for (int i = 0; i < NWK_BUFFERS_AMOUNT; i++) {
+		memset(&requests[i], 0, sizeof(NWK_DataReq_t));
+		requests[i].dstAddr = 0x0002;
+		requests[i].dstEndpoint = 1;
+		requests[i].srcEndpoint = 1;
+		requests[i].data = payload;
+		requests[i].size = sizeof(payload);
+		requests[i].confirm = dataConf;
+		NWK_DataReq(&requests[i]);
+	}
+
+	benchAdvance(100);
+	local = measurePass();
+
+	printf("buffers %3d   idle %6.1f   forwarding %6.1f   "
+			"data requests %6.1f   ns/pass\n",
+			NWK_BUFFERS_AMOUNT, idle, forward, local);
+
+	return 0;
+}
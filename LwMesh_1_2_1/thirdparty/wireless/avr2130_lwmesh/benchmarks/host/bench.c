@@ -0,0 +1,335 @@
+/**
+ * \file bench.c
+ *
+ * \brief Host benchmark support: PHY model and virtual time
+ *
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ *
+ */
+
+/*
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/*- Includes ---------------------------------------------------------------*/
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sysConfig.h"
+#include "sysTimer.h"
+#include "phy.h"
+#include "nwk.h"
+#include "nwkFrame.h"
+#include "bench.h"
+
+/*- Definitions ------------------------------------------------------------*/
+#define BENCH_PAN_ID               0x1234
+
+/*- Prototypes -------------------------------------------------------------*/
+void SYS_HwExpiry_Cb(void);
+
+/*- Variables --------------------------------------------------------------*/
+static uint32_t benchTimeMs;
+static bool benchAutoConfirm;
+static uint8_t *benchPhyCurrent;
+static uint8_t *benchPhyStaged;
+static uint8_t benchPhyBuffer[BENCH_MAX_FRAME_SIZE + 1];
+static uint32_t benchPhyFrameCount;
+
+/*- Implementations --------------------------------------------------------*/
+
+/*************************************************************************//**
+*  @brief Initializes the stack for a node with the address @a addr
+*****************************************************************************/
+void benchInit(uint16_t addr)
+{
+	benchTimeMs = 0;
+	benchAutoConfirm = false;
+	benchPhyCurrent = NULL;
+	benchPhyStaged = NULL;
+	benchPhyFrameCount = 0;
+	srand(addr);
+
+	SYS_TimerInit();
+	NWK_Init();
+	NWK_SetAddr(addr);
+	NWK_SetPanId(BENCH_PAN_ID);
+}
+
+/*************************************************************************//**
+*  @brief Runs one pass of the main loop, the way SYS_TaskHandler() does
+*****************************************************************************/
+void benchTick(void)
+{
+	if (benchAutoConfirm && benchPhyCurrent) {
+		benchPhyConfirm(PHY_STATUS_SUCCESS);
+	}
+
+	NWK_TaskHandler();
+	SYS_TimerTaskHandler();
+}
+
+/*************************************************************************//**
+*  @brief Advances the virtual time by @a ms, running the main loop once
+*  for every millisecond
+*****************************************************************************/
+void benchAdvance(uint32_t ms)
+{
+	for (uint32_t i = 0; i < ms; i++) {
+		benchTimeMs++;
+
+		if (0 == benchTimeMs % SYS_TIMER_INTERVAL) {
+			SYS_HwExpiry_Cb();
+		}
+
+		benchTick();
+	}
+}
+
+/*************************************************************************//**
+*  @brief Returns the virtual time in ms
+*****************************************************************************/
+uint32_t benchTime(void)
+{
+	return benchTimeMs;
+}
+
+/*************************************************************************//**
+*  @brief Returns a host clock value in ns
+*****************************************************************************/
+uint64_t benchClock(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/*************************************************************************//**
+*  @brief Makes the PHY confirm every frame with success on the next main
+*  loop pass
+*****************************************************************************/
+void benchPhyAutoConfirm(bool enable)
+{
+	benchAutoConfirm = enable;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+bool benchPhyBusy(void)
+{
+	return NULL != benchPhyCurrent;
+}
+
+/*************************************************************************//**
+*  @brief Returns a copy of the frame in the air, length byte first
+*****************************************************************************/
+uint8_t *benchPhyFrame(void)
+{
+	return benchPhyBuffer;
+}
+
+/*************************************************************************//**
+*  @brief Returns the number of frames sent since benchInit()
+*****************************************************************************/
+uint32_t benchPhyFrames(void)
+{
+	return benchPhyFrameCount;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static void benchPhyStart(uint8_t *data)
+{
+	memcpy(benchPhyBuffer, data, data[0] + 1);
+	benchPhyCurrent = data;
+	benchPhyFrameCount++;
+}
+
+/*************************************************************************//**
+*  @brief Completes the frame in the air with the PHY @a status
+*****************************************************************************/
+void benchPhyConfirm(uint8_t status)
+{
+	benchPhyCurrent = NULL;
+
+	if (benchPhyStaged) {
+		uint8_t *data = benchPhyStaged;
+
+		benchPhyStaged = NULL;
+		benchPhyStart(data);
+	}
+
+	PHY_DataConf(status);
+}
+
+/*************************************************************************//**
+*  @brief Delivers a received frame of @a size bytes (no length, no CRC)
+*****************************************************************************/
+void benchPhyReceive(uint8_t *data, uint8_t size, uint8_t lqi)
+{
+	PHY_DataInd_t ind;
+
+	ind.data = data;
+	ind.size = size;
+	ind.lqi = lqi;
+	ind.rssi = -50;
+	PHY_DataInd(&ind);
+}
+
+/*************************************************************************//**
+*  @brief Builds a one hop data frame with @a size payload bytes
+*  @return Size of the frame
+*****************************************************************************/
+uint8_t benchDataFrame(uint8_t *data, uint16_t src, uint16_t dst,
+		uint8_t seq, bool ackRequest, uint8_t size)
+{
+	NwkFrameHeader_t *header = (NwkFrameHeader_t *)data;
+
+	memset(data, 0, sizeof(NwkFrameHeader_t) + size);
+	header->macFcf = (NWK_BROADCAST_ADDR == dst) ? 0x8841 : 0x8861;
+	header->macSeq = seq;
+	header->macDstPanId = BENCH_PAN_ID;
+	header->macDstAddr = dst;
+	header->macSrcAddr = src;
+	header->nwkFcf.ackRequest = ackRequest;
+	header->nwkSeq = seq;
+	header->nwkSrcAddr = src;
+	header->nwkDstAddr = dst;
+	header->nwkSrcEndpoint = 1;
+	header->nwkDstEndpoint = 1;
+
+	return sizeof(NwkFrameHeader_t) + size;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static int benchCompare(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a;
+	uint32_t y = *(const uint32_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+/*************************************************************************//**
+*  @brief Returns the @a percent percentile of @a values (sorts them)
+*****************************************************************************/
+uint32_t benchPercentile(uint32_t *values, uint32_t amount, uint8_t percent)
+{
+	if (0 == amount) {
+		return 0;
+	}
+
+	qsort(values, amount, sizeof(uint32_t), benchCompare);
+	return values[(amount - 1) * percent / 100];
+}
+
+/*- PHY interface ----------------------------------------------------------*/
+
+void PHY_Init(void)
+{
+}
+
+void PHY_SetRxState(bool rx)
+{
+	(void)rx;
+}
+
+void PHY_SetChannel(uint8_t channel)
+{
+	(void)channel;
+}
+
+void PHY_SetPanId(uint16_t panId)
+{
+	(void)panId;
+}
+
+void PHY_SetShortAddr(uint16_t addr)
+{
+	(void)addr;
+}
+
+void PHY_SetTxPower(uint8_t txPower)
+{
+	(void)txPower;
+}
+
+void PHY_Sleep(void)
+{
+}
+
+void PHY_Wakeup(void)
+{
+}
+
+void PHY_TaskHandler(void)
+{
+}
+
+void PHY_SetIEEEAddr(uint8_t *ieee_addr)
+{
+	(void)ieee_addr;
+}
+
+int8_t PHY_EdReq(void)
+{
+	return 0;
+}
+
+uint16_t PHY_RandomReq(void)
+{
+	return rand();
+}
+
+/*************************************************************************//**
+*  @brief Encrypts one block. A cheap mixing function stands in for the AES
+*  engine, so the benchmarks measure the stack and not the cipher
+*****************************************************************************/
+void PHY_EncryptReq(uint8_t *text, uint8_t *key)
+{
+	for (uint8_t i = 0; i < 16; i++) {
+		text[i] = (uint8_t)((text[i] ^ key[i]) * 167 + i);
+	}
+}
+
+/*************************************************************************//**
+*  @brief Accepts a frame; a second one is staged while the first is in the
+*  air, like the SPI transceiver drivers do
+*****************************************************************************/
+void PHY_DataReq(uint8_t *data)
+{
+	if (benchPhyCurrent) {
+		benchPhyStaged = data;
+	} else {
+		benchPhyStart(data);
+	}
+}
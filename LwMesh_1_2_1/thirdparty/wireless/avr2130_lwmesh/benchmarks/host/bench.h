@@ -0,0 +1,70 @@
+/**
+ * \file bench.h
+ *
+ * \brief Host benchmark support interface
+ *
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ *
+ */
+
+/*
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+/*- Includes ---------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/*- Definitions ------------------------------------------------------------*/
+#define BENCH_RUNS                 5
+#define BENCH_MAX_FRAME_SIZE       127
+
+/*- Prototypes -------------------------------------------------------------*/
+void benchInit(uint16_t addr);
+void benchTick(void);
+void benchAdvance(uint32_t ms);
+uint32_t benchTime(void);
+uint64_t benchClock(void);
+
+void benchPhyAutoConfirm(bool enable);
+bool benchPhyBusy(void);
+uint8_t *benchPhyFrame(void);
+uint32_t benchPhyFrames(void);
+void benchPhyConfirm(uint8_t status);
+void benchPhyReceive(uint8_t *data, uint8_t size, uint8_t lqi);
+
+uint8_t benchDataFrame(uint8_t *data, uint16_t src, uint16_t dst,
+		uint8_t seq, bool ackRequest, uint8_t size);
+uint32_t benchPercentile(uint32_t *values, uint32_t amount, uint8_t percent);
+
+#endif /* _BENCH_H_ */
@@ -0,0 +1,65 @@
+/**
+ * \file compiler.h
+ *
+ * \brief Host replacement for the ASF compiler header
+ *
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ *
+ */
+
+/*
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+#ifndef _COMPILER_H_
+#define _COMPILER_H_
+
+/*- Includes ---------------------------------------------------------------*/
+#include <stdint.h>
+
+/*- Definitions ------------------------------------------------------------*/
+#define COMPILER_PACK_SET(alignment)   _Pragma("pack(push, 1)")
+#define COMPILER_PACK_RESET()          _Pragma("pack(pop)")
+
+/*- Types ------------------------------------------------------------------*/
+typedef uint32_t irqflags_t;
+
+/*- Implementations --------------------------------------------------------*/
+static inline irqflags_t cpu_irq_save(void)
+{
+	return 0;
+}
+
+static inline void cpu_irq_restore(irqflags_t flags)
+{
+	(void)flags;
+}
+
+#endif /* _COMPILER_H_ */
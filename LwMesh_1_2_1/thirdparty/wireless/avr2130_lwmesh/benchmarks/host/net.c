@@ -0,0 +1,723 @@
+/**
+ * \file net.c
+ *
+ * \brief Multi-node network simulator with a simple 802.15.4 radio model
+ *
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ *
+ */
+
+/*
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/*- Includes ---------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <dlfcn.h>
+#include <unistd.h>
+#include "net.h"
+
+/*- Definitions ------------------------------------------------------------*/
+#define NET_TIMER_INTERVAL         10 /* ms, SYS_TIMER_INTERVAL */
+#define NET_BYTE_TIME              32 /* us at 250 kbit/s */
+#define NET_PHY_OVERHEAD           6 /* preamble, SFD and PHR */
+#define NET_CRC_SIZE               2
+#define NET_ACK_TIME               (192 + 11 * NET_BYTE_TIME) /* us */
+#define NET_BACKOFF_PERIOD         320 /* us */
+#define NET_MIN_BE                 3
+#define NET_MAX_BE                 5
+#define NET_MAX_CSMA_BACKOFFS      4
+#define NET_MAX_FRAME_RETRIES      3
+#define NET_NONE                   0xffff
+
+#define NET_STATUS_SUCCESS         0 /* PHY_STATUS_* */
+#define NET_STATUS_CHANNEL_ACCESS_FAILURE 1
+#define NET_STATUS_NO_ACK          2
+
+/*- Types ------------------------------------------------------------------*/
+enum {
+	NET_EVENT_ATTEMPT,
+	NET_EVENT_DATA_END,
+	NET_EVENT_ACK_END,
+};
+
+typedef struct NetEvent_t {
+	uint64_t time;
+	uint16_t node;
+	uint8_t type;
+} NetEvent_t;
+
+typedef struct NetNode_t {
+	void *handle;
+	void (*init)(uint16_t id, uint16_t addr, const NetHooks_t *hooks);
+	void (*tick)(bool timer);
+	void (*receive)(uint8_t *data, uint8_t size, uint8_t lqi, int8_t rssi);
+	void (*confirm)(uint8_t status);
+	bool (*send)(uint16_t dstAddr, uint8_t size, uint8_t options,
+			uint32_t tag);
+	bool (*sendLarge)(uint16_t dstAddr, uint16_t size, uint32_t tag);
+	bool (*busy)(void);
+
+	float x;
+	float y;
+	uint16_t *neighbours;
+	uint16_t neighboursAmount;
+
+	/* transmitter */
+	uint8_t frame[NET_MAX_FRAME_SIZE + 1];
+	uint8_t *queued;
+	bool active;
+	bool transmitting;
+	bool acked;
+	uint8_t be;
+	uint8_t backoffs;
+	uint8_t retries;
+
+	/* receiver */
+	uint16_t rxActive;
+	uint16_t rxSource;
+	bool rxCollided;
+} NetNode_t;
+
+/*- Prototypes -------------------------------------------------------------*/
+static void netHookDataReq(uint16_t node, uint8_t *data);
+static void netHookDataInd(uint16_t node, uint16_t src, uint16_t size,
+		uint32_t tag);
+static void netHookDataConf(uint16_t node, uint32_t tag, uint8_t status);
+
+/*- Variables --------------------------------------------------------------*/
+static const NetHooks_t netHooks = {
+	netHookDataReq, netHookDataInd, netHookDataConf
+};
+static NetNode_t *netNodes;
+static uint16_t netAmount;
+static float *netLinks;
+static uint8_t *netHearing;
+static bool netNeighboursValid;
+static NetEvent_t *netEvents;
+static uint32_t netEventsAmount;
+static uint32_t netTimeMs;
+static uint64_t netNow;
+static NetStats_t netStatistics;
+static void (*netInd)(uint16_t node, uint16_t src, uint16_t size,
+		uint32_t tag);
+static void (*netConf)(uint16_t node, uint32_t tag, uint8_t status);
+
+/*- Implementations --------------------------------------------------------*/
+
+/*************************************************************************//**
+*****************************************************************************/
+static void *netSymbol(void *handle, const char *name)
+{
+	void *symbol = dlsym(handle, name);
+
+	if (NULL == symbol) {
+		fprintf(stderr, "net: %s not found\n", name);
+		exit(1);
+	}
+
+	return symbol;
+}
+
+/*************************************************************************//**
+*  @brief Loads @a amount nodes from the shared @a library. Every node gets
+*  a private copy of the library, so each one has its own stack state.
+*****************************************************************************/
+void netInit(const char *library, uint16_t amount, unsigned seed)
+{
+	char dir[] = "/tmp/lwmesh-net-XXXXXX";
+	char path[sizeof(dir) + 32];
+	FILE *file;
+	uint8_t *image;
+	long size;
+
+	file = fopen(library, "rb");
+
+	if (NULL == file || NULL == mkdtemp(dir)) {
+		fprintf(stderr, "net: cannot load %s\n", library);
+		exit(1);
+	}
+
+	fseek(file, 0, SEEK_END);
+	size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	image = malloc(size);
+
+	if (size != (long)fread(image, 1, size, file)) {
+		fprintf(stderr, "net: cannot read %s\n", library);
+		exit(1);
+	}
+
+	fclose(file);
+
+	netAmount = amount;
+	netNodes = calloc(amount, sizeof(NetNode_t));
+	netLinks = calloc((size_t)amount * amount, sizeof(float));
+	netHearing = calloc((size_t)amount * amount, 1);
+	netEvents = malloc(sizeof(NetEvent_t) * amount * 2);
+	netEventsAmount = 0;
+	netNeighboursValid = false;
+	netTimeMs = 0;
+	netNow = 0;
+	memset(&netStatistics, 0, sizeof(netStatistics));
+	srand(seed);
+
+	for (uint16_t i = 0; i < amount; i++) {
+		NetNode_t *node = &netNodes[i];
+
+		snprintf(path, sizeof(path), "%s/node%u.so", dir, i);
+		file = fopen(path, "wb");
+		fwrite(image, 1, size, file);
+		fclose(file);
+
+		node->handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+		unlink(path);
+
+		if (NULL == node->handle) {
+			fprintf(stderr, "net: %s\n", dlerror());
+			exit(1);
+		}
+
+		node->init = netSymbol(node->handle, "nodeInit");
+		node->tick = netSymbol(node->handle, "nodeTick");
+		node->receive = netSymbol(node->handle, "nodeReceive");
+		node->confirm = netSymbol(node->handle, "nodeConfirm");
+		node->send = netSymbol(node->handle, "nodeSend");
+		node->sendLarge = netSymbol(node->handle, "nodeSendLarge");
+		node->busy = netSymbol(node->handle, "nodeBusy");
+		node->rxSource = NET_NONE;
+	}
+
+	rmdir(dir);
+	free(image);
+
+	for (uint16_t i = 0; i < amount; i++) {
+		netNodes[i].init(i, netAddr(i), &netHooks);
+	}
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+void netClose(void)
+{
+	for (uint16_t i = 0; i < netAmount; i++) {
+		dlclose(netNodes[i].handle);
+		free(netNodes[i].neighbours);
+	}
+
+	free(netNodes);
+	free(netLinks);
+	free(netHearing);
+	free(netEvents);
+}
+
+/*************************************************************************//**
+*  @brief Sets the functions called for data indications and confirmations
+*  of all nodes
+*****************************************************************************/
+void netSetHandlers(void (*ind)(uint16_t node, uint16_t src, uint16_t size,
+		uint32_t tag), void (*conf)(uint16_t node, uint32_t tag,
+		uint8_t status))
+{
+	netInd = ind;
+	netConf = conf;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+uint16_t netAddr(uint16_t node)
+{
+	return node + 1;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static uint16_t netNode(uint16_t addr)
+{
+	return (addr >= 1 && addr <= netAmount) ? addr - 1 : NET_NONE;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+void netPlace(uint16_t node, float x, float y)
+{
+	netNodes[node].x = x;
+	netNodes[node].y = y;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+void netPlaceGrid(uint16_t columns, float spacing)
+{
+	for (uint16_t i = 0; i < netAmount; i++) {
+		netPlace(i, (i % columns) * spacing, (i / columns) * spacing);
+	}
+}
+
+/*************************************************************************//**
+*  @brief Sets all links from the node positions. Links up to @a reliable
+*  apart never lose frames, the delivery ratio then falls linearly to zero
+*  at @a maximum.
+*****************************************************************************/
+void netSetRange(float reliable, float maximum)
+{
+	for (uint16_t i = 0; i < netAmount; i++) {
+		for (uint16_t j = 0; j < netAmount; j++) {
+			float dx = netNodes[i].x - netNodes[j].x;
+			float dy = netNodes[i].y - netNodes[j].y;
+			float d = sqrtf(dx * dx + dy * dy);
+			float prr = 0;
+
+			if (i == j) {
+				prr = 0;
+			} else if (d <= reliable) {
+				prr = 1;
+			} else if (d < maximum) {
+				prr = (maximum - d) / (maximum - reliable);
+			}
+
+			netLinks[(size_t)i * netAmount + j] = prr;
+		}
+	}
+
+	netNeighboursValid = false;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+void netSetLink(uint16_t from, uint16_t to, float prr)
+{
+	netLinks[(size_t)from * netAmount + to] = prr;
+	netNeighboursValid = false;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+float netLink(uint16_t from, uint16_t to)
+{
+	return netLinks[(size_t)from * netAmount + to];
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static void netUpdateNeighbours(void)
+{
+	for (uint16_t i = 0; i < netAmount; i++) {
+		NetNode_t *node = &netNodes[i];
+
+		free(node->neighbours);
+		node->neighbours = malloc(sizeof(uint16_t) * netAmount);
+		node->neighboursAmount = 0;
+
+		for (uint16_t j = 0; j < netAmount; j++) {
+			if (netLink(i, j) > 0) {
+				node->neighbours[node->neighboursAmount++] = j;
+			}
+		}
+	}
+
+	netNeighboursValid = true;
+}
+
+/*- Event queue ------------------------------------------------------------*/
+
+/*************************************************************************//**
+*****************************************************************************/
+static void netSchedule(uint64_t time, uint16_t node, uint8_t type)
+{
+	uint32_t i = netEventsAmount++;
+
+	while (i > 0) {
+		uint32_t parent = (i - 1) / 2;
+
+		if (netEvents[parent].time <= time) {
+			break;
+		}
+
+		netEvents[i] = netEvents[parent];
+		i = parent;
+	}
+
+	netEvents[i].time = time;
+	netEvents[i].node = node;
+	netEvents[i].type = type;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static NetEvent_t netNextEvent(void)
+{
+	NetEvent_t top = netEvents[0];
+	NetEvent_t last = netEvents[--netEventsAmount];
+	uint32_t i = 0;
+
+	while (1) {
+		uint32_t child = i * 2 + 1;
+
+		if (child >= netEventsAmount) {
+			break;
+		}
+
+		if (child + 1 < netEventsAmount &&
+				netEvents[child + 1].time < netEvents[child].time) {
+			child++;
+		}
+
+		if (last.time <= netEvents[child].time) {
+			break;
+		}
+
+		netEvents[i] = netEvents[child];
+		i = child;
+	}
+
+	netEvents[i] = last;
+	return top;
+}
+
+/*- Radio ------------------------------------------------------------------*/
+
+/*************************************************************************//**
+*****************************************************************************/
+static uint64_t netBackoff(NetNode_t *node)
+{
+	return (uint64_t)(rand() % (1 << node->be)) * NET_BACKOFF_PERIOD;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static uint64_t netAirTime(NetNode_t *node)
+{
+	return (uint64_t)(node->frame[0] + NET_CRC_SIZE + NET_PHY_OVERHEAD) *
+			NET_BYTE_TIME;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static uint16_t netFrameDst(NetNode_t *node)
+{
+	return node->frame[6] | (node->frame[7] << 8);
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static bool netFrameAckRequest(NetNode_t *node)
+{
+	return node->frame[1] & 0x20;
+}
+
+/*************************************************************************//**
+*  @brief Starts the CSMA-CA procedure for the frame of the @a node
+*****************************************************************************/
+static void netStart(uint16_t id, uint8_t *data)
+{
+	NetNode_t *node = &netNodes[id];
+
+	memcpy(node->frame, data, data[0] + 1);
+	node->active = true;
+	node->be = NET_MIN_BE;
+	node->backoffs = 0;
+	node->retries = 0;
+	netSchedule(netNow + netBackoff(node), id, NET_EVENT_ATTEMPT);
+}
+
+/*************************************************************************//**
+*  @brief Completes the frame of the node @a id, a queued frame is started
+*  before the confirmation, like the transceiver drivers do
+*****************************************************************************/
+static void netFinish(uint16_t id, uint8_t status)
+{
+	NetNode_t *node = &netNodes[id];
+
+	node->active = false;
+
+	if (node->queued) {
+		uint8_t *data = node->queued;
+
+		node->queued = NULL;
+		netStart(id, data);
+	}
+
+	node->confirm(status);
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static void netAttempt(uint16_t id)
+{
+	NetNode_t *node = &netNodes[id];
+
+	if (node->rxActive > 0) {
+		netStatistics.channelBusy++;
+
+		if (++node->backoffs > NET_MAX_CSMA_BACKOFFS) {
+			netFinish(id, NET_STATUS_CHANNEL_ACCESS_FAILURE);
+			return;
+		}
+
+		if (node->be < NET_MAX_BE) {
+			node->be++;
+		}
+
+		netSchedule(netNow + netBackoff(node), id, NET_EVENT_ATTEMPT);
+		return;
+	}
+
+	netStatistics.transmissions++;
+
+	if (0xffff == netFrameDst(node)) {
+		netStatistics.broadcasts++;
+	}
+
+	node->transmitting = true;
+
+	for (uint16_t i = 0; i < node->neighboursAmount; i++) {
+		uint16_t r = node->neighbours[i];
+		NetNode_t *receiver = &netNodes[r];
+
+		if (receiver->transmitting) {
+			continue;
+		}
+
+		if (receiver->rxActive > 0) {
+			receiver->rxCollided = true;
+			netStatistics.collisions++;
+		} else {
+			receiver->rxSource = id;
+			receiver->rxCollided = false;
+		}
+
+		receiver->rxActive++;
+		netHearing[(size_t)id * netAmount + r] = 1;
+	}
+
+	netSchedule(netNow + netAirTime(node), id, NET_EVENT_DATA_END);
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static void netDeliver(uint16_t from, uint16_t to)
+{
+	NetNode_t *node = &netNodes[from];
+	float prr = netLink(from, to);
+	int lqi = (int)(prr * 255) + rand() % 33 - 16;
+
+	if (lqi < 0) {
+		lqi = 0;
+	} else if (lqi > 255) {
+		lqi = 255;
+	}
+
+	netNodes[to].receive(node->frame + 1, node->frame[0], lqi,
+			(int8_t)(-50 - (1 - prr) * 40));
+}
+
+/*************************************************************************//**
+*  @brief Ends the frame of the node @a id. Every neighbour that heard it
+*  alone, and not while transmitting, decodes it with the link delivery
+*  ratio. Unicast frames are only passed to the addressed node.
+*****************************************************************************/
+static void netDataEnd(uint16_t id)
+{
+	NetNode_t *node = &netNodes[id];
+	uint16_t dst = netFrameDst(node);
+	uint16_t dstNode = netNode(dst);
+	bool delivered = false;
+
+	for (uint16_t i = 0; i < node->neighboursAmount; i++) {
+		uint16_t r = node->neighbours[i];
+		NetNode_t *receiver = &netNodes[r];
+		size_t hearing = (size_t)id * netAmount + r;
+		bool decoded;
+
+		if (!netHearing[hearing]) {
+			continue;
+		}
+
+		netHearing[hearing] = 0;
+		decoded = receiver->rxSource == id && !receiver->rxCollided &&
+				!receiver->transmitting &&
+				(float)rand() / RAND_MAX < netLink(id, r);
+
+		if (receiver->rxSource == id) {
+			receiver->rxSource = NET_NONE;
+		}
+
+		if (0 == --receiver->rxActive) {
+			receiver->rxCollided = false;
+		}
+
+		if (decoded && (0xffff == dst || r == dstNode)) {
+			delivered = delivered || r == dstNode;
+			netDeliver(id, r);
+		}
+	}
+
+	if (!netFrameAckRequest(node)) {
+		node->transmitting = false;
+		netFinish(id, NET_STATUS_SUCCESS);
+		return;
+	}
+
+	node->acked = delivered &&
+			(float)rand() / RAND_MAX < netLink(dstNode, id);
+	netSchedule(netNow + NET_ACK_TIME, id, NET_EVENT_ACK_END);
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static void netAckEnd(uint16_t id)
+{
+	NetNode_t *node = &netNodes[id];
+
+	node->transmitting = false;
+
+	if (node->acked) {
+		netFinish(id, NET_STATUS_SUCCESS);
+	} else if (node->retries < NET_MAX_FRAME_RETRIES) {
+		node->retries++;
+		node->be = NET_MIN_BE;
+		node->backoffs = 0;
+		netStatistics.retries++;
+		netSchedule(netNow + netBackoff(node), id, NET_EVENT_ATTEMPT);
+	} else {
+		netFinish(id, NET_STATUS_NO_ACK);
+	}
+}
+
+/*************************************************************************//**
+*  @brief Runs the network for @a ms. Every node runs its main loop once per
+*  ms, the radio events are handled in between with us resolution.
+*****************************************************************************/
+void netRun(uint32_t ms)
+{
+	if (!netNeighboursValid) {
+		netUpdateNeighbours();
+	}
+
+	for (uint32_t t = 0; t < ms; t++) {
+		uint64_t end = ((uint64_t)netTimeMs + 1) * 1000;
+
+		netNow = (uint64_t)netTimeMs * 1000;
+
+		for (uint16_t i = 0; i < netAmount; i++) {
+			netNodes[i].tick(0 == netTimeMs % NET_TIMER_INTERVAL);
+		}
+
+		while (netEventsAmount && netEvents[0].time < end) {
+			NetEvent_t event = netNextEvent();
+
+			netNow = event.time;
+
+			if (NET_EVENT_ATTEMPT == event.type) {
+				netAttempt(event.node);
+			} else if (NET_EVENT_DATA_END == event.type) {
+				netDataEnd(event.node);
+			} else {
+				netAckEnd(event.node);
+			}
+		}
+
+		netTimeMs++;
+	}
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+uint32_t netTime(void)
+{
+	return netTimeMs;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+NetStats_t *netStats(void)
+{
+	return &netStatistics;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+bool netSend(uint16_t node, uint16_t dstAddr, uint8_t size, uint8_t options,
+		uint32_t tag)
+{
+	return netNodes[node].send(dstAddr, size, options, tag);
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+bool netSendLarge(uint16_t node, uint16_t dstAddr, uint16_t size,
+		uint32_t tag)
+{
+	return netNodes[node].sendLarge(dstAddr, size, tag);
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+bool netBusy(uint16_t node)
+{
+	return netNodes[node].busy();
+}
+
+/*- Node hooks -------------------------------------------------------------*/
+
+/*************************************************************************//**
+*  @brief A second frame is queued while the first one is in progress
+*****************************************************************************/
+static void netHookDataReq(uint16_t node, uint8_t *data)
+{
+	if (netNodes[node].active) {
+		netNodes[node].queued = data;
+	} else {
+		netStart(node, data);
+	}
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static void netHookDataInd(uint16_t node, uint16_t src, uint16_t size,
+		uint32_t tag)
+{
+	if (netInd) {
+		netInd(node, src, size, tag);
+	}
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static void netHookDataConf(uint16_t node, uint32_t tag, uint8_t status)
+{
+	if (netConf) {
+		netConf(node, tag, status);
+	}
+}
@@ -0,0 +1,94 @@
+/**
+ * \file net.h
+ *
+ * \brief Multi-node network simulator interface
+ *
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ *
+ */
+
+/*
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+#ifndef _NET_H_
+#define _NET_H_
+
+/*- Includes ---------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/*- Definitions ------------------------------------------------------------*/
+#define NET_MAX_FRAME_SIZE         127
+#define NET_TAG_SIZE               4
+
+/*- Types ------------------------------------------------------------------*/
+
+/* Every node runs its own copy of the stack (host/node.c), loaded from a
+ * shared library. The nodes talk to the simulator through these calls. */
+typedef struct NetHooks_t {
+	void (*dataReq)(uint16_t node, uint8_t *data);
+	void (*dataInd)(uint16_t node, uint16_t src, uint16_t size, uint32_t tag);
+	void (*dataConf)(uint16_t node, uint32_t tag, uint8_t status);
+} NetHooks_t;
+
+typedef struct NetStats_t {
+	uint32_t transmissions;
+	uint32_t broadcasts;
+	uint32_t retries;
+	uint32_t collisions;
+	uint32_t channelBusy;
+} NetStats_t;
+
+/*- Prototypes -------------------------------------------------------------*/
+void netInit(const char *library, uint16_t amount, unsigned seed);
+void netClose(void);
+void netSetHandlers(void (*ind)(uint16_t node, uint16_t src, uint16_t size,
+		uint32_t tag), void (*conf)(uint16_t node, uint32_t tag,
+		uint8_t status));
+
+void netPlace(uint16_t node, float x, float y);
+void netPlaceGrid(uint16_t columns, float spacing);
+void netSetRange(float reliable, float maximum);
+void netSetLink(uint16_t from, uint16_t to, float prr);
+float netLink(uint16_t from, uint16_t to);
+
+void netRun(uint32_t ms);
+uint32_t netTime(void);
+NetStats_t *netStats(void);
+uint16_t netAddr(uint16_t node);
+
+bool netSend(uint16_t node, uint16_t dstAddr, uint8_t size, uint8_t options,
+		uint32_t tag);
+bool netSendLarge(uint16_t node, uint16_t dstAddr, uint16_t size,
+		uint32_t tag);
+bool netBusy(uint16_t node);
+
+#endif /* _NET_H_ */
@@ -0,0 +1,334 @@
+/**
+ * \file node.c
+ *
+ * \brief One simulated node: the stack behind the simulator interface
+ *
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ *
+ */
+
+/*
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/*- Includes ---------------------------------------------------------------*/
+#include <stdlib.h>
+#include <string.h>
+#include "sysConfig.h"
+#include "sysTimer.h"
+#include "phy.h"
+#include "nwk.h"
+#include "net.h"
+
+/*- Definitions ------------------------------------------------------------*/
+#define NODE_REQUESTS_AMOUNT       8
+#define NODE_ENDPOINT              1
+#define NODE_PAN_ID                0x1234
+
+/*- Types ------------------------------------------------------------------*/
+typedef struct NodeRequest_t {
+	NWK_DataReq_t req;
+	uint32_t tag;
+	bool busy;
+} NodeRequest_t;
+
+/*- Prototypes -------------------------------------------------------------*/
+void SYS_HwExpiry_Cb(void);
+
+/*- Variables --------------------------------------------------------------*/
+static const NetHooks_t *nodeHooks;
+static uint16_t nodeId;
+static NodeRequest_t nodeRequests[NODE_REQUESTS_AMOUNT];
+static uint8_t nodePayload[NODE_REQUESTS_AMOUNT][NWK_MAX_PAYLOAD_SIZE];
+#ifdef NWK_ENABLE_FRAGMENTATION
+static NWK_FragReq_t nodeFragReq;
+static uint32_t nodeFragTag;
+static uint8_t nodeFragTxBuffer[NWK_FRAG_MAX_SIZE];
+static uint8_t nodeFragRxBuffer[NWK_FRAG_MAX_SIZE];
+#endif
+
+/*- Implementations --------------------------------------------------------*/
+
+/*************************************************************************//**
+*****************************************************************************/
+static uint32_t nodeTag(uint8_t *data, uint16_t size)
+{
+	uint32_t tag = 0;
+
+	if (size >= NET_TAG_SIZE) {
+		memcpy(&tag, data, NET_TAG_SIZE);
+	}
+
+	return tag;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static bool nodeDataInd(NWK_DataInd_t *ind)
+{
+	nodeHooks->dataInd(nodeId, ind->srcAddr, ind->size,
+			nodeTag(ind->data, ind->size));
+	return true;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static void nodeDataConf(NWK_DataReq_t *req)
+{
+	NodeRequest_t *request = (NodeRequest_t *)req;
+
+	request->busy = false;
+	nodeHooks->dataConf(nodeId, request->tag, req->status);
+}
+
+#ifdef NWK_ENABLE_FRAGMENTATION
+
+/*************************************************************************//**
+*****************************************************************************/
+static void nodeFragInd(NWK_FragInd_t *ind)
+{
+	nodeHooks->dataInd(nodeId, ind->srcAddr, ind->size,
+			nodeTag(ind->data, ind->size));
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static void nodeFragConf(NWK_FragReq_t *req)
+{
+	nodeHooks->dataConf(nodeId, nodeFragTag, req->status);
+	nodeFragTag = 0;
+}
+
+#endif
+
+/*************************************************************************//**
+*  @brief Starts the stack of the node @a id with the network address
+*  @a addr
+*****************************************************************************/
+void nodeInit(uint16_t id, uint16_t addr, const NetHooks_t *hooks)
+{
+	nodeId = id;
+	nodeHooks = hooks;
+
+	SYS_TimerInit();
+	NWK_Init();
+	NWK_SetAddr(addr);
+	NWK_SetPanId(NODE_PAN_ID);
+	NWK_OpenEndpoint(NODE_ENDPOINT, nodeDataInd);
+
+#ifdef NWK_ENABLE_FRAGMENTATION
+	NWK_FragSetRxBuffer(nodeFragRxBuffer, sizeof(nodeFragRxBuffer),
+			nodeFragInd);
+#endif
+}
+
+/*************************************************************************//**
+*  @brief Runs one pass of the main loop, @a timer is set every
+*  SYS_TIMER_INTERVAL ms
+*****************************************************************************/
+void nodeTick(bool timer)
+{
+	if (timer) {
+		SYS_HwExpiry_Cb();
+	}
+
+	NWK_TaskHandler();
+	SYS_TimerTaskHandler();
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+void nodeReceive(uint8_t *data, uint8_t size, uint8_t lqi, int8_t rssi)
+{
+	PHY_DataInd_t ind;
+
+	ind.data = data;
+	ind.size = size;
+	ind.lqi = lqi;
+	ind.rssi = rssi;
+	PHY_DataInd(&ind);
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+void nodeConfirm(uint8_t status)
+{
+	PHY_DataConf(status);
+}
+
+/*************************************************************************//**
+*  @brief Sends @a size bytes to @a dstAddr, the @a tag is carried in the
+*  first payload bytes
+*  @return @c false if all requests of the node are in use
+*****************************************************************************/
+bool nodeSend(uint16_t dstAddr, uint8_t size, uint8_t options, uint32_t tag)
+{
+	for (uint8_t i = 0; i < NODE_REQUESTS_AMOUNT; i++) {
+		NodeRequest_t *request = &nodeRequests[i];
+
+		if (request->busy) {
+			continue;
+		}
+
+		memset(&request->req, 0, sizeof(NWK_DataReq_t));
+		memcpy(nodePayload[i], &tag, NET_TAG_SIZE);
+		request->req.dstAddr = dstAddr;
+		request->req.dstEndpoint = NODE_ENDPOINT;
+		request->req.srcEndpoint = NODE_ENDPOINT;
+		request->req.options = options;
+		request->req.data = nodePayload[i];
+		request->req.size = size;
+		request->req.confirm = nodeDataConf;
+		request->tag = tag;
+		request->busy = true;
+		NWK_DataReq(&request->req);
+
+		return true;
+	}
+
+	return false;
+}
+
+/*************************************************************************//**
+*  @brief Sends @a size bytes to @a dstAddr with the fragmentation service
+*  @return @c false if a transfer is in progress or the service is not
+*  enabled
+*****************************************************************************/
+bool nodeSendLarge(uint16_t dstAddr, uint16_t size, uint32_t tag)
+{
+#ifdef NWK_ENABLE_FRAGMENTATION
+	if (nodeFragTag || size > sizeof(nodeFragTxBuffer)) {
+		return false;
+	}
+
+	memset(&nodeFragReq, 0, sizeof(NWK_FragReq_t));
+	memcpy(nodeFragTxBuffer, &tag, NET_TAG_SIZE);
+	nodeFragReq.dstAddr = dstAddr;
+	nodeFragReq.dstEndpoint = NODE_ENDPOINT;
+	nodeFragReq.srcEndpoint = NODE_ENDPOINT;
+	nodeFragReq.data = nodeFragTxBuffer;
+	nodeFragReq.size = size;
+	nodeFragReq.confirm = nodeFragConf;
+	nodeFragTag = tag;
+	NWK_FragReq(&nodeFragReq);
+
+	return true;
+#else
+	(void)dstAddr;
+	(void)size;
+	(void)tag;
+	return false;
+#endif
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+bool nodeBusy(void)
+{
+	return NWK_Busy();
+}
+
+/*- PHY interface ----------------------------------------------------------*/
+
+void PHY_Init(void)
+{
+}
+
+void PHY_SetRxState(bool rx)
+{
+	(void)rx;
+}
+
+void PHY_SetChannel(uint8_t channel)
+{
+	(void)channel;
+}
+
+void PHY_SetPanId(uint16_t panId)
+{
+	(void)panId;
+}
+
+void PHY_SetShortAddr(uint16_t addr)
+{
+	(void)addr;
+}
+
+void PHY_SetTxPower(uint8_t txPower)
+{
+	(void)txPower;
+}
+
+void PHY_Sleep(void)
+{
+}
+
+void PHY_Wakeup(void)
+{
+}
+
+void PHY_TaskHandler(void)
+{
+}
+
+void PHY_SetIEEEAddr(uint8_t *ieee_addr)
+{
+	(void)ieee_addr;
+}
+
+int8_t PHY_EdReq(void)
+{
+	return 0;
+}
+
+uint16_t PHY_RandomReq(void)
+{
+	return rand();
+}
+
+/*************************************************************************//**
+*  @brief Encrypts one block with a cheap mixing function in place of the
+*  AES engine
+*****************************************************************************/
+void PHY_EncryptReq(uint8_t *text, uint8_t *key)
+{
+	for (uint8_t i = 0; i < 16; i++) {
+		text[i] = (uint8_t)((text[i] ^ key[i]) * 167 + i);
+	}
+}
+
+/*************************************************************************//**
+*  @brief Hands the frame to the simulated radio, which confirms it through
+*  nodeConfirm()
+*****************************************************************************/
+void PHY_DataReq(uint8_t *data)
+{
+	nodeHooks->dataReq(nodeId, data);
+}
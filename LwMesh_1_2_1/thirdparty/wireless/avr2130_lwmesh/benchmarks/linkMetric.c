@@ -0,0 +1,125 @@
+/**
+ * \file linkMetric.c
+ *
+ * \brief Delivery ratio and cost of the route metric in a lossy grid
+ *
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ *
+ */
+
+/*
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/*- Includes ---------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nwk.h"
+#include "net.h"
+
+/*- Definitions ------------------------------------------------------------*/
+#define COLUMNS                    7
+#define NODES_AMOUNT               (COLUMNS * COLUMNS)
+#define MESSAGES                   1000
+#define MESSAGE_INTERVAL           100 /* ms */
+#define PAYLOAD_SIZE               20
+#define SINK                       0
+#define SEEDS                      3
+
+/*- Variables --------------------------------------------------------------*/
+static uint16_t destination[MESSAGES + 1];
+static bool delivered[MESSAGES + 1];
+static uint32_t deliveredAmount;
+
+/*- Implementations --------------------------------------------------------*/
+
+/*************************************************************************//**
+*****************************************************************************/
+static void dataInd(uint16_t node, uint16_t src, uint16_t size, uint32_t tag)
+{
+	if (tag && tag <= MESSAGES && destination[tag] == node &&
+			!delivered[tag]) {
+		delivered[tag] = true;
+		deliveredAmount++;
+	}
+}
+
+/*************************************************************************//**
+*  @brief Runs MESSAGES acknowledged messages on a 7 x 7 grid. Direct
+*  neighbours hear each other reliably, diagonal neighbours lose about a
+*  quarter of the frames and nodes two steps apart about two thirds. Every
+*  message goes from a random node to the sink in the corner, or back.
+*****************************************************************************/
+int main(int argc, char *argv[])
+{
+	char library[256];
+	uint32_t transmissions = 0, sent = 0, total = 0;
+
+	snprintf(library, sizeof(library), "%s.so", argv[0]);
+
+	for (unsigned seed = 1; seed <= SEEDS; seed++) {
+		netInit(library, NODES_AMOUNT, seed);
+		netSetHandlers(dataInd, NULL);
+		netPlaceGrid(COLUMNS, 1.0);
+		netSetRange(1.0, 2.5);
+		netRun(1000);
+
+		memset(delivered, 0, sizeof(delivered));
+		deliveredAmount = 0;
+
+		for (uint32_t tag = 1; tag <= MESSAGES; tag++) {
+			uint16_t node = 1 + rand() % (NODES_AMOUNT - 1);
+
+			if (tag % 2) {
+				destination[tag] = SINK;
+				sent += netSend(node, netAddr(SINK), PAYLOAD_SIZE,
+						NWK_OPT_ACK_REQUEST, tag);
+			} else {
+				destination[tag] = node;
+				sent += netSend(SINK, netAddr(node), PAYLOAD_SIZE,
+						NWK_OPT_ACK_REQUEST, tag);
+			}
+
+			netRun(MESSAGE_INTERVAL);
+		}
+
+		netRun(5000);
+		transmissions += netStats()->transmissions;
+		total += deliveredAmount;
+		netClose();
+	}
+
+	printf("%.1f%% delivered, %.2f transmissions per delivered message, "
+			"%u not accepted\n", 100.0 * total / (SEEDS * MESSAGES),
+			(double)transmissions / total, SEEDS * MESSAGES - sent);
+
+	return 0;
+}
@@ -0,0 +1,195 @@
+/**
+ * \file priority.c
+ *
+ * \brief Transmit latency per priority class
+ *
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ *
+ */
+
+/*
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/*- Includes ---------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "sysConfig.h"
+#include "phy.h"
+#include "nwk.h"
+#include "bench.h"
+
+/*- Definitions ------------------------------------------------------------*/
+#define DURATION                   10000 /* ms */
+#define TX_AIR_TIME                2 /* ms */
+#define BULK_REQUESTS              6
+#define NORMAL_INTERVAL            20 /* ms */
+#define HIGH_INTERVAL              50 /* ms */
+#define SAMPLES_AMOUNT             (DURATION / TX_AIR_TIME)
+
+/*- Types ------------------------------------------------------------------*/
+typedef struct Request_t {
+	NWK_DataReq_t req;
+	uint8_t type;
+	bool busy;
+	uint32_t queued;
+} Request_t;
+
+/*- Variables --------------------------------------------------------------*/
+static Request_t bulk[BULK_REQUESTS];
+static Request_t normal;
+static Request_t high;
+static uint8_t payload[32];
+static uint32_t samples[NWK_PRIORITIES_AMOUNT][SAMPLES_AMOUNT];
+static uint32_t samplesAmount[NWK_PRIORITIES_AMOUNT];
+static uint32_t dropped[NWK_PRIORITIES_AMOUNT];
+static uint8_t classes[NWK_PRIORITIES_AMOUNT];
+static const char *names[NWK_PRIORITIES_AMOUNT] = {"normal", "low", "high"};
+
+/*- Implementations --------------------------------------------------------*/
+
+/*************************************************************************//**
+*****************************************************************************/
+static void dataConf(NWK_DataReq_t *req);
+
+/*************************************************************************//**
+*  @brief Queues the request for the traffic @a type (NWK_PRIORITY_*)
+*****************************************************************************/
+static void send(Request_t *request, uint8_t type)
+{
+	memset(&request->req, 0, sizeof(NWK_DataReq_t));
+	request->req.dstAddr = 0x0002;
+	request->req.dstEndpoint = 1;
+	request->req.srcEndpoint = 1;
+	request->req.priority = classes[type];
+	request->req.data = payload;
+	request->req.size = sizeof(payload);
+	request->req.confirm = dataConf;
+	request->type = type;
+	request->busy = true;
+	request->queued = benchTime();
+	NWK_DataReq(&request->req);
+}
+
+/*************************************************************************//**
+*  @brief Records the latency of the request, bulk requests are queued
+*  again straight away. A request that found no free frame is retried and
+*  keeps its original queueing time.
+*****************************************************************************/
+static void dataConf(NWK_DataReq_t *req)
+{
+	Request_t *request = (Request_t *)req;
+	uint8_t type = request->type;
+
+	if (NWK_OUT_OF_MEMORY_STATUS == req->status) {
+		NWK_DataReq(req);
+		return;
+	}
+
+	request->busy = false;
+
+	if (samplesAmount[type] < SAMPLES_AMOUNT) {
+		samples[type][samplesAmount[type]++] =
+				benchTime() - request->queued;
+	}
+
+	if (NWK_PRIORITY_LOW == type) {
+		send(request, type);
+	}
+}
+
+/*************************************************************************//**
+*  @brief Keeps BULK_REQUESTS low priority requests queued, while normal
+*  and high priority requests come every NORMAL_INTERVAL and
+*  HIGH_INTERVAL ms. Every frame takes TX_AIR_TIME ms in the air. Without
+*  BENCH_CLASSES all requests are sent as normal priority.
+*****************************************************************************/
+int main(void)
+{
+	uint32_t sent = 0;
+	uint32_t started = 0;
+
+	for (uint8_t i = 0; i < NWK_PRIORITIES_AMOUNT; i++) {
+#ifdef BENCH_CLASSES
+		classes[i] = i;
+#else
+		classes[i] = NWK_PRIORITY_NORMAL;
+#endif
+	}
+
+	benchInit(0x0001);
+
+	for (int i = 0; i < BULK_REQUESTS; i++) {
+		send(&bulk[i], NWK_PRIORITY_LOW);
+	}
+
+	for (uint32_t t = 0; t < DURATION; t++) {
+		if (0 == t % NORMAL_INTERVAL) {
+			if (normal.busy) {
+				dropped[NWK_PRIORITY_NORMAL]++;
+			} else {
+				send(&normal, NWK_PRIORITY_NORMAL);
+			}
+		}
+
+		if (0 == t % HIGH_INTERVAL) {
+			if (high.busy) {
+				dropped[NWK_PRIORITY_HIGH]++;
+			} else {
+				send(&high, NWK_PRIORITY_HIGH);
+			}
+		}
+
+		if (benchPhyBusy() && sent != benchPhyFrames()) {
+			sent = benchPhyFrames();
+			started = t;
+		}
+
+		if (benchPhyBusy() && t - started >= TX_AIR_TIME) {
+			benchPhyConfirm(PHY_STATUS_SUCCESS);
+		}
+
+		benchAdvance(1);
+	}
+
+	for (uint8_t i = 0; i < NWK_PRIORITIES_AMOUNT; i++) {
+		uint8_t type = (i + 2) % NWK_PRIORITIES_AMOUNT;
+		uint32_t amount = samplesAmount[type];
+
+		printf("%-6s  %5u frames  latency p50 %3u  p90 %3u  p99 %3u ms"
+				"  %u not sent in time\n", names[type], amount,
+				benchPercentile(samples[type], amount, 50),
+				benchPercentile(samples[type], amount, 90),
+				benchPercentile(samples[type], amount, 99),
+				dropped[type]);
+	}
+
+	return 0;
+}
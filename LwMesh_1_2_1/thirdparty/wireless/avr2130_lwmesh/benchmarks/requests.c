@@ -0,0 +1,118 @@
+/**
+ * \file requests.c
+ *
+ * \brief Data requests served per second of CPU time
+ *
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ *
+ */
+
+/*
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/*- Includes ---------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "sysConfig.h"
+#include "nwk.h"
+#include "bench.h"
+
+/*- Definitions ------------------------------------------------------------*/
+#ifndef BENCH_QUEUED
+#define BENCH_QUEUED               10
+#endif
+
+#define PASSES                     200000
+
+/*- Variables --------------------------------------------------------------*/
+static NWK_DataReq_t requests[BENCH_QUEUED];
+static uint8_t payload[16];
+static uint32_t confirmed;
+
+/*- Implementations --------------------------------------------------------*/
+
+/*************************************************************************//**
+*  @brief Counts the request and puts it back into the queue
+*****************************************************************************/
+static void dataConf(NWK_DataReq_t *req)
+{
+	if (NWK_SUCCESS_STATUS == req->status) {
+		confirmed++;
+	}
+
+	NWK_DataReq(req);
+}
+
+/*************************************************************************//**
+*  @brief Keeps BENCH_QUEUED requests in the queue, every confirmed request
+*  is submitted again. The transceiver finishes each frame by the next pass
+*  of the main loop, so the radio is never the bottleneck.
+*****************************************************************************/
+int main(void)
+{
+	double best = 0;
+
+	benchInit(0x0001);
+	benchPhyAutoConfirm(true);
+
+	for (int i = 0; i < BENCH_QUEUED; i++) {
+		memset(&requests[i], 0, sizeof(NWK_DataReq_t));
+		requests[i].dstAddr = 0x0002;
+		requests[i].dstEndpoint = 1;
+		requests[i].srcEndpoint = 1;
+		requests[i].data = payload;
+		requests[i].size = sizeof(payload);
+		requests[i].confirm = dataConf;
+		NWK_DataReq(&requests[i]);
+	}
+
+	for (int run = 0; run < BENCH_RUNS; run++) {
+		uint64_t start = benchClock();
+		double rate;
+
+		confirmed = 0;
+
+		for (int i = 0; i < PASSES; i++) {
+			benchTick();
+		}
+
+		rate = confirmed * 1e9 / (benchClock() - start);
+
+		if (rate > best) {
+			best = rate;
+		}
+	}
+
+	printf("queued %3d   %9.0f requests/s   %.2f per pass\n",
+			BENCH_QUEUED, best, (double)confirmed / PASSES);
+
+	return 0;
+}
@@ -0,0 +1,207 @@
+/**
+ * \file routes.c
+ *
+ * \brief Route table lookup and eviction cost against the table size
+ *
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ *
+ */
+
+/*
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/*- Includes ---------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "sysConfig.h"
+#include "nwk.h"
+#include "nwkRoute.h"
+#include "bench.h"
+
+/*- Definitions ------------------------------------------------------------*/
+#define OPERATIONS                 1000000
+#define KEYS_AMOUNT                4096
+#define FIRST_DST                  0x0100
+
+/*- Variables --------------------------------------------------------------*/
+static uint16_t keys[KEYS_AMOUNT];
+
+/*- Implementations --------------------------------------------------------*/
+
+/*************************************************************************//**
+*  @brief Fills the key list with random destinations, @a present of them
+*  are in the table
+*****************************************************************************/
+static void prepareKeys(bool present)
+{
+	for (int i = 0; i < KEYS_AMOUNT; i++) {
+		keys[i] = FIRST_DST + rand() % NWK_ROUTE_TABLE_SIZE +
+				(present ? 0 : NWK_ROUTE_TABLE_SIZE);
+	}
+}
+
+/*************************************************************************//**
+*  @brief Returns the best of BENCH_RUNS averages of one lookup, ns
+*****************************************************************************/
+static double measureLookup(void)
+{
+	double best = 0;
+	uint32_t found = 0;
+
+	for (int run = 0; run < BENCH_RUNS; run++) {
+		uint64_t start = benchClock();
+
+		for (int i = 0; i < OPERATIONS; i++) {
+			if (NWK_RouteFindEntry(keys[i % KEYS_AMOUNT], 0)) {
+				found++;
+			}
+		}
+
+		double ns = (double)(benchClock() - start) / OPERATIONS;
+
+		if (0 == run || ns < best) {
+			best = ns;
+		}
+	}
+
+	return found ? best : -best;
+}
+
+/*************************************************************************//**
+*  @brief Returns the best of BENCH_RUNS averages of adding a route to a
+*  full table, which replaces an existing one, ns
+*****************************************************************************/
+static double measureEviction(void)
+{
+	uint16_t dst = FIRST_DST + NWK_ROUTE_TABLE_SIZE;
+	double best = 0;
+
+	for (int run = 0; run < BENCH_RUNS; run++) {
+		uint64_t start = benchClock();
+
+		for (int i = 0; i < OPERATIONS / 10; i++) {
+			nwkRouteUpdateEntry(dst, 0, 0x0002, 0xff);
+
+			if (NWK_ROUTE_UNKNOWN == ++dst) {
+				dst = FIRST_DST + NWK_ROUTE_TABLE_SIZE;
+			}
+		}
+
+		double ns = (double)(benchClock() - start) / (OPERATIONS / 10);
+
+		if (0 == run || ns < best) {
+			best = ns;
+		}
+	}
+
+	return best;
+}
+
+/*************************************************************************//**
+*  @brief Fixes two routes while a table full of routes is learned, then
+*  releases them and learns a table full of new routes. Only the first one
+*  is used again after it was released.
+*  @return Number of the NWK_ROUTE_TABLE_SIZE newest routes that are kept
+*****************************************************************************/
+static int checkUnfixed(void)
+{
+	NWK_RouteTableEntry_t *entry = NWK_RouteTable();
+	NWK_RouteTableEntry_t *unused;
+	uint16_t dst = FIRST_DST;
+	int kept = 0;
+
+	for (int i = 0; i < NWK_ROUTE_TABLE_SIZE; i++, entry++) {
+		if (NWK_ROUTE_UNKNOWN != entry->dstAddr) {
+			NWK_RouteFreeEntry(entry);
+		}
+	}
+
+	nwkRouteUpdateEntry(dst, 0, 0x0002, 0xff);
+	entry = NWK_RouteFindEntry(dst, 0);
+	entry->fixed = 1;
+	nwkRouteUpdateEntry(++dst, 0, 0x0002, 0xff);
+	unused = NWK_RouteFindEntry(dst, 0);
+	unused->fixed = 1;
+
+	for (int i = 0; i < NWK_ROUTE_TABLE_SIZE * 2; i++) {
+		nwkRouteUpdateEntry(++dst, 0, 0x0002, 0xff);
+	}
+
+	entry->fixed = 0;
+	unused->fixed = 0;
+	nwkRouteUpdateEntry(FIRST_DST, 0, 0x0002, 0xff);
+
+	for (int i = 0; i < NWK_ROUTE_TABLE_SIZE * 2; i++) {
+		nwkRouteUpdateEntry(++dst, 0, 0x0002, 0xff);
+	}
+
+	for (int i = 0; i < NWK_ROUTE_TABLE_SIZE; i++) {
+		if (NWK_RouteFindEntry(dst - i, 0)) {
+			kept++;
+		}
+	}
+
+	return kept;
+}
+
+/*************************************************************************//**
+*  @brief Fills a table of NWK_ROUTE_TABLE_SIZE entries and measures lookups
+*  of present and absent destinations, then adding routes to new
+*  destinations. Last checks that a route that was fixed before is evicted
+*  again.
+*****************************************************************************/
+int main(void)
+{
+	double hit, miss, evict;
+	int kept;
+
+	benchInit(0x0001);
+
+	for (int i = 0; i < NWK_ROUTE_TABLE_SIZE; i++) {
+		nwkRouteUpdateEntry(FIRST_DST + i, 0, 0x0002, 0xff);
+	}
+
+	prepareKeys(true);
+	hit = measureLookup();
+	prepareKeys(false);
+	miss = measureLookup();
+	evict = measureEviction();
+	kept = checkUnfixed();
+
+	printf("entries %4d   found %7.1f   not found %7.1f   "
+			"replaced %7.1f   ns/operation\n", NWK_ROUTE_TABLE_SIZE,
+			hit, -miss, evict);
+	printf("entries %4d   %d of %d new routes kept after two routes were "
+			"fixed and released\n", NWK_ROUTE_TABLE_SIZE, kept,
+			NWK_ROUTE_TABLE_SIZE);
+
+	return kept == NWK_ROUTE_TABLE_SIZE ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+/**
+ * \file smallBuffers.c
+ *
+ * \brief Frame pool occupancy under a burst of acknowledged frames
+ *
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ *
+ */
+
+/*
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/*- Includes ---------------------------------------------------------------*/
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include "sysConfig.h"
+#include "phy.h"
+#include "nwk.h"
+#include "nwkFrame.h"
+#include "bench.h"
+
+/*- Definitions ------------------------------------------------------------*/
+#define DURATION                   2000 /* ms */
+#define RX_BURST                   16
+#define RX_BURST_INTERVAL          100 /* ms */
+#define RX_SOURCES                 4
+#define TX_AIR_TIME                2 /* ms */
+#define REQUESTS                   4
+#define PAYLOAD_SIZE               8
+
+/*- Variables --------------------------------------------------------------*/
+static NWK_DataReq_t requests[REQUESTS];
+static uint8_t payload[PAYLOAD_SIZE];
+static uint8_t frame[BENCH_MAX_FRAME_SIZE];
+static uint32_t indications;
+static uint32_t confirms;
+
+/*- Implementations --------------------------------------------------------*/
+
+/*************************************************************************//**
+*****************************************************************************/
+static bool dataInd(NWK_DataInd_t *ind)
+{
+	(void)ind;
+	indications++;
+	return true;
+}
+
+/*************************************************************************//**
+*  @brief Sends the request again as soon as it is confirmed, so the
+*  application always has REQUESTS requests queued
+*****************************************************************************/
+static void dataConf(NWK_DataReq_t *req)
+{
+	if (NWK_SUCCESS_STATUS == req->status) {
+		confirms++;
+	}
+
+	NWK_DataReq(req);
+}
+
+/*************************************************************************//**
+*  @brief Receives a burst of RX_BURST acknowledged frames, one per ms, from
+*  RX_SOURCES neighbours every RX_BURST_INTERVAL ms, while the application
+*  keeps sending short frames. Every frame takes TX_AIR_TIME ms in the air.
+*****************************************************************************/
+int main(void)
+{
+	uint32_t offered = 0;
+	uint32_t sent = 0;
+	uint32_t started = 0;
+	uint32_t acks = 0;
+	uint32_t ram = NWK_BUFFERS_AMOUNT * sizeof(NwkFrame_t) +
+			NWK_SMALL_BUFFERS_AMOUNT * (offsetof(NwkFrame_t, data) +
+			sizeof(NwkFrameHeader_t) + NWK_FRAME_SMALL_PAYLOAD_SIZE);
+
+	benchInit(0x0001);
+	NWK_OpenEndpoint(1, dataInd);
+
+	for (int i = 0; i < REQUESTS; i++) {
+		memset(&requests[i], 0, sizeof(NWK_DataReq_t));
+		requests[i].dstAddr = 0x0002;
+		requests[i].dstEndpoint = 1;
+		requests[i].srcEndpoint = 1;
+		requests[i].data = payload;
+		requests[i].size = sizeof(payload);
+		requests[i].confirm = dataConf;
+		NWK_DataReq(&requests[i]);
+	}
+
+	for (uint32_t t = 0; t < DURATION; t++) {
+		if (t % RX_BURST_INTERVAL < RX_BURST) {
+			uint8_t size = benchDataFrame(frame,
+					0x0010 + offered % RX_SOURCES, 0x0001,
+					offered / RX_SOURCES, true, 16);
+
+			benchPhyReceive(frame, size, 0xff);
+			offered++;
+		}
+
+		if (benchPhyBusy() && sent != benchPhyFrames()) {
+			NwkFrameHeader_t *header =
+					(NwkFrameHeader_t *)(benchPhyFrame() + 1);
+
+			if (0 == header->nwkSrcEndpoint) {
+				acks++;
+			}
+
+			sent = benchPhyFrames();
+			started = t;
+		}
+
+		if (benchPhyBusy() && t - started >= TX_AIR_TIME) {
+			benchPhyConfirm(PHY_STATUS_SUCCESS);
+		}
+
+		benchAdvance(1);
+	}
+
+	printf("buffers %d+%d small, %u bytes (%u host bytes per frame)\n",
+			NWK_BUFFERS_AMOUNT, NWK_SMALL_BUFFERS_AMOUNT, ram,
+			(unsigned)sizeof(NwkFrame_t));
+	printf("  received %u of %u frames, %u ACKs sent, %u data frames/s\n",
+			indications, offered, acks, confirms * 1000 / DURATION);
+
+	return 0;
+}
@@ -46,9 +46,13 @@
 #include <stdbool.h>
 #include "sysConfig.h"
 #include "nwkRoute.h"
+#include "nwkNeighbour.h"
 #include "nwkGroup.h"
 #include "nwkSecurity.h"
 #include "nwkDataReq.h"
+#include "nwkFrag.h"
+#include "nwkStream.h"
+#include "nwkTx.h"
 
 /**
  * \ingroup group_lwmesh_nwk
@@ -43,6 +43,7 @@
 
 /*- Includes ---------------------------------------------------------------*/
 #include <stdint.h>
+#include "nwkFrag.h"
 
 /*- Types ------------------------------------------------------------------*/
 enum {
@@ -50,8 +51,22 @@ enum {
 	NWK_COMMAND_ROUTE_ERROR         = 0x01,
 	NWK_COMMAND_ROUTE_REQUEST       = 0x02,
 	NWK_COMMAND_ROUTE_REPLY         = 0x03,
+	NWK_COMMAND_FRAGMENT            = 0x04,
+	NWK_COMMAND_FRAGMENT_ACK        = 0x05,
+	NWK_COMMAND_STREAM_DATA         = 0x06,
+	NWK_COMMAND_STREAM_ACK          = 0x07,
 };
+
+enum {
+	NWK_COMMAND_FRAGMENT_ACK_REQUEST = 1 << 0,
+};
+
+enum {
+	NWK_COMMAND_STREAM_ACK_REQUEST   = 1 << 0,
+};
+
 COMPILER_PACK_SET(1)
+/* Delayed ACKs are followed by the sequence numbers of more frames */
 typedef struct  NwkCommandAck_t {
 	uint8_t id;
 	uint8_t seq;
@@ -65,12 +80,14 @@ typedef struct  NwkCommandRouteError_t {
 	uint8_t multicast;
 } NwkCommandRouteError_t;
 
+/* Requests without the last byte are not limited in hops */
 typedef struct  NwkCommandRouteRequest_t {
 	uint8_t id;
 	uint16_t srcAddr;
 	uint16_t dstAddr;
 	uint8_t multicast;
 	uint8_t linkQuality;
+	uint8_t ttl;
 } NwkCommandRouteRequest_t;
 
 typedef struct  NwkCommandRouteReply_t {
@@ -81,5 +98,41 @@ typedef struct  NwkCommandRouteReply_t {
 	uint8_t forwardLinkQuality;
 	uint8_t reverseLinkQuality;
 } NwkCommandRouteReply_t;
+
+typedef struct  NwkCommandFragment_t {
+	uint8_t id;
+	uint8_t seq;
+	uint8_t index;
+	uint8_t control;
+	struct {
+		uint8_t srcEndpoint : 4;
+		uint8_t dstEndpoint : 4;
+	};
+	uint16_t size;
+} NwkCommandFragment_t;
+
+typedef struct  NwkCommandFragmentAck_t {
+	uint8_t id;
+	uint8_t seq;
+	uint8_t status;
+	uint8_t bitmap[NWK_FRAG_BITMAP_SIZE];
+} NwkCommandFragmentAck_t;
+
+typedef struct  NwkCommandStreamData_t {
+	uint8_t id;
+	uint8_t seq;
+	uint8_t base;
+	uint8_t control;
+	struct {
+		uint8_t srcEndpoint : 4;
+		uint8_t dstEndpoint : 4;
+	};
+} NwkCommandStreamData_t;
+
+typedef struct  NwkCommandStreamAck_t {
+	uint8_t id;
+	uint8_t seq;
+	uint8_t bitmap;
+} NwkCommandStreamAck_t;
 COMPILER_PACK_RESET()
 #endif /* _NWK_COMMAND_H_ */
@@ -53,19 +53,39 @@ enum {
 	NWK_OPT_BROADCAST_PAN_ID     = 1 << 2,
 	NWK_OPT_LINK_LOCAL           = 1 << 3,
 	NWK_OPT_MULTICAST            = 1 << 4,
+	NWK_OPT_RETRY                = 1 << 5,
+	NWK_OPT_AGGREGATE            = 1 << 6,
 };
 
+/* Frames of high priority are always sent first, normal and low priority
+ * frames share the remaining bandwidth in the NWK_PRIORITY_WEIGHT ratio */
+enum {
+	NWK_PRIORITY_NORMAL          = 0,
+	NWK_PRIORITY_LOW             = 1,
+	NWK_PRIORITY_HIGH            = 2,
+	NWK_PRIORITIES_AMOUNT        = 3,
+};
+
+typedef struct NWK_DataSegment_t {
+	uint8_t *data;
+	uint8_t size;
+} NWK_DataSegment_t;
+
 typedef struct NWK_DataReq_t {
 	/* service fields */
 	void *next;
+	void *prev;
 	void *frame;
 	uint8_t state;
+	NWK_DataSegment_t *segments;
+	uint8_t segmentsAmount;
 
 	/* request parameters */
 	uint16_t dstAddr;
 	uint8_t dstEndpoint;
 	uint8_t srcEndpoint;
 	uint8_t options;
+	uint8_t priority;
 #ifdef NWK_ENABLE_MULTICAST
 	uint8_t memberRadius;
 	uint8_t nonMemberRadius;
@@ -77,10 +97,19 @@ typedef struct NWK_DataReq_t {
 	/* confirmation parameters */
 	uint8_t status;
 	uint8_t control;
+	uint8_t attempts;
 } NWK_DataReq_t;
 
 /*- Prototypes -------------------------------------------------------------*/
 void NWK_DataReq(NWK_DataReq_t *req);
+void NWK_DataReqGather(NWK_DataReq_t *req, NWK_DataSegment_t *segments,
+		uint8_t amount);
+uint8_t *NWK_DataReqReserve(NWK_DataReq_t *req, uint8_t size);
+void NWK_DataReqCommit(NWK_DataReq_t *req);
+void NWK_DataReqRelease(NWK_DataReq_t *req);
+uint8_t NWK_DataReqCredits(void);
+void NWK_DataReqSetCreditHandler(uint8_t watermark,
+		void (*handler)(uint8_t credits));
 
 void nwkDataReqInit(void);
 void nwkDataReqTaskHandler(void);
@@ -0,0 +1,108 @@
+/**
+ * \file nwkFrag.h
+ *
+ * \brief Fragmentation of large payloads interface
+ *
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ *
+ */
+
+/*
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+#ifndef _NWK_FRAG_H_
+#define _NWK_FRAG_H_
+
+/*- Includes ---------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "sysConfig.h"
+#include "nwkRx.h"
+
+/*- Definitions ------------------------------------------------------------*/
+#define NWK_FRAG_MAX_FRAGMENTS       64
+#define NWK_FRAG_BITMAP_SIZE         (NWK_FRAG_MAX_FRAGMENTS / 8)
+#define NWK_FRAG_HEADER_SIZE         7 /* sizeof(NwkCommandFragment_t) */
+#define NWK_FRAG_FRAGMENT_SIZE       (NWK_MAX_PAYLOAD_SIZE - \
+	NWK_FRAG_HEADER_SIZE - NWK_SECURITY_MIC_SIZE)
+#define NWK_FRAG_MAX_SIZE            (NWK_FRAG_MAX_FRAGMENTS * \
+	NWK_FRAG_FRAGMENT_SIZE)
+
+#ifdef NWK_ENABLE_FRAGMENTATION
+
+/*- Types ------------------------------------------------------------------*/
+typedef struct NWK_FragReq_t {
+	/* service fields */
+	void *next;
+	uint8_t state;
+	uint8_t seq;
+	uint8_t index;
+	uint8_t frames;
+	uint8_t acked[NWK_FRAG_BITMAP_SIZE];
+
+	/* request parameters */
+	uint16_t dstAddr;
+	uint8_t dstEndpoint;
+	uint8_t srcEndpoint;
+	uint8_t options;
+	uint8_t *data;
+	uint16_t size;
+	void (*confirm)(struct NWK_FragReq_t *req);
+
+	/* confirmation parameters */
+	uint8_t status;
+	uint8_t attempts;
+} NWK_FragReq_t;
+
+typedef struct NWK_FragInd_t {
+	uint16_t srcAddr;
+	uint8_t srcEndpoint;
+	uint8_t dstEndpoint;
+	uint8_t options;
+	uint8_t *data;
+	uint16_t size;
+	uint8_t lqi;
+	int8_t rssi;
+} NWK_FragInd_t;
+
+/*- Prototypes -------------------------------------------------------------*/
+void NWK_FragReq(NWK_FragReq_t *req);
+void NWK_FragSetRxBuffer(uint8_t *buffer, uint16_t size,
+		void (*handler)(NWK_FragInd_t *ind));
+
+void nwkFragInit(void);
+bool nwkFragReceived(NWK_DataInd_t *ind);
+bool nwkFragAckReceived(NWK_DataInd_t *ind);
+void nwkFragTaskHandler(void);
+
+#endif /* NWK_ENABLE_FRAGMENTATION */
+
+#endif /* _NWK_FRAG_H_ */
@@ -43,12 +43,44 @@
 
 /*- Includes ---------------------------------------------------------------*/
 #include <stdint.h>
+#include <stdbool.h>
 #include "compiler.h"
 
 /*- Definitions ------------------------------------------------------------*/
 #define NWK_FRAME_MAX_PAYLOAD_SIZE   127
+#define NWK_FRAME_SMALL_PAYLOAD_SIZE 12
+#define PHY_CRC_SIZE                 2
+
+#define NWK_FRAME_TX_STATES_AMOUNT         10
+#define NWK_FRAME_RX_STATES_AMOUNT         5
+#define NWK_FRAME_SECURITY_STATES_AMOUNT   5
+#define NWK_FRAME_RD_STATES_AMOUNT         1
 
 /*- Types ------------------------------------------------------------------*/
+/* Every frame state has its own queue, so the state values must be dense.
+ * Each module numbers its states starting from its base value below. */
+enum {
+	NWK_FRAME_STATE_FREE           = 0,
+	NWK_FRAME_STATE_FREE_SMALL     = 1,
+	NWK_FRAME_STATE_ALLOCATED      = 2,
+	NWK_FRAME_STATE_TX_BASE        = 3,
+	NWK_FRAME_STATE_RX_BASE        = NWK_FRAME_STATE_TX_BASE +
+			NWK_FRAME_TX_STATES_AMOUNT,
+	NWK_FRAME_STATE_SECURITY_BASE  = NWK_FRAME_STATE_RX_BASE +
+			NWK_FRAME_RX_STATES_AMOUNT,
+	NWK_FRAME_STATE_RD_BASE        = NWK_FRAME_STATE_SECURITY_BASE +
+			NWK_FRAME_SECURITY_STATES_AMOUNT,
+	NWK_FRAME_STATES_AMOUNT        = NWK_FRAME_STATE_RD_BASE +
+			NWK_FRAME_RD_STATES_AMOUNT,
+};
+
+enum {
+	NWK_FRAME_CLASS_DATA     = 0,
+	NWK_FRAME_CLASS_RX       = 1,
+	NWK_FRAME_CLASS_COMMAND  = 2,
+	NWK_FRAME_CLASSES_AMOUNT = 3,
+};
+
 COMPILER_PACK_SET(1)
 typedef struct  NwkFrameHeader_t {
 	uint16_t macFcf;
@@ -62,7 +94,10 @@ typedef struct  NwkFrameHeader_t {
 		uint8_t security   : 1;
 		uint8_t linkLocal  : 1;
 		uint8_t multicast  : 1;
-		uint8_t reserved   : 4;
+		uint8_t aggregate  : 1;
+		uint8_t srcElided  : 1;
+		uint8_t dstElided  : 1;
+		uint8_t reserved   : 1;
 	} nwkFcf;
 	uint8_t nwkSeq;
 	uint16_t nwkSrcAddr;
@@ -80,36 +115,68 @@ typedef struct  NwkFrameMulticastHeader_t {
 	uint16_t maxMemberRadius    : 4;
 } NwkFrameMulticastHeader_t;
 
-typedef struct NwkFrame_t {
-	uint8_t state;
+typedef struct  NwkFrameAggregateHeader_t {
+	uint8_t srcEndpoint : 4;
+	uint8_t dstEndpoint : 4;
 	uint8_t size;
+} NwkFrameAggregateHeader_t;
 
-	union {
-		NwkFrameHeader_t header;
-		uint8_t data[NWK_FRAME_MAX_PAYLOAD_SIZE];
-	};
+typedef struct NwkFrame_t {
+	struct NwkFrame_t *next;
+	struct NwkFrame_t *prev;
 
+	uint8_t state;
 	uint8_t *payload;
 
 	union {
 		struct {
 			uint8_t lqi;
 			int8_t rssi;
+			bool rebroadcast;
 		} rx;
 
 		struct {
 			uint8_t status;
 			uint16_t timeout;
 			uint8_t control;
+			uint8_t priority;
+			uint8_t attempts;
+#ifdef NWK_ENABLE_ADAPTIVE_ACK_WAIT
+			uint16_t ackWait;
+#endif
+#ifdef NWK_ENABLE_BROADCAST_SUPPRESSION
+			uint8_t copies;
+#endif
+#ifdef NWK_ENABLE_HEADER_COMPRESSION
+			uint8_t elided;
+#endif
+			void *owner;
 			void (*confirm)(struct NwkFrame_t *frame);
 		} tx;
 	};
+
+	/* The frame data must be the last field, since small frames only
+	 * have storage for the header and NWK_FRAME_SMALL_PAYLOAD_SIZE bytes */
+	uint8_t size;
+
+	union {
+		NwkFrameHeader_t header;
+		/* One extra byte receives the LQI when the PHY reads a frame
+		 * directly into the buffer */
+		uint8_t data[NWK_FRAME_MAX_PAYLOAD_SIZE + 1];
+	};
 } NwkFrame_t;
 COMPILER_PACK_RESET()
 /*- Prototypes -------------------------------------------------------------*/
+uint16_t NWK_FrameRefusedCount(uint8_t frameClass);
+
 void nwkFrameInit(void);
-NwkFrame_t *nwkFrameAlloc(void);
+NwkFrame_t *nwkFrameAlloc(uint8_t frameClass, uint8_t size);
 void nwkFrameFree(NwkFrame_t *frame);
+uint8_t nwkFrameAvailable(uint8_t frameClass);
+void nwkFrameSetState(NwkFrame_t *frame, uint8_t state);
+void nwkFrameInsert(NwkFrame_t *frame, uint8_t state, NwkFrame_t *next);
+NwkFrame_t *nwkFrameFirst(uint8_t state);
 NwkFrame_t *nwkFrameNext(NwkFrame_t *frame);
 void nwkFrameCommandInit(NwkFrame_t *frame);
 
@@ -0,0 +1,84 @@
+/**
+ * \file nwkNeighbour.h
+ *
+ * \brief Neighbour table interface
+ *
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ *
+ */
+
+/*
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+#ifndef _NWK_NEIGHBOUR_H_
+#define _NWK_NEIGHBOUR_H_
+
+/*- Includes ---------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "sysConfig.h"
+#include "nwkFrame.h"
+
+/*- Definitions ------------------------------------------------------------*/
+#define NWK_NEIGHBOUR_ETX_UNIT       16 /* 1/16 of a transmission */
+#define NWK_NEIGHBOUR_ETX_MAX        (64 * NWK_NEIGHBOUR_ETX_UNIT)
+
+#ifdef NWK_ENABLE_NEIGHBOUR_TABLE
+
+/*- Types ------------------------------------------------------------------*/
+typedef struct NWK_NeighbourEntry_t {
+	uint32_t lastHeard;    /* SYS_TimerTime() of the last received frame */
+	uint16_t addr;
+	uint16_t txAttempts;
+	uint16_t txSuccesses;
+	uint16_t txEtx;        /* From the delivery ratio, 0 if unknown */
+	uint16_t rtt;          /* Smoothed NWK ACK RTT in ms, 0 if unknown */
+	uint8_t lqi;           /* Smoothed linearized LQI, 0 if nothing heard */
+	int8_t rssi;           /* Smoothed RSSI in dBm */
+	uint8_t windowAttempts  : 4;
+	uint8_t windowSuccesses : 4;
+} NWK_NeighbourEntry_t;
+
+/*- Prototypes -------------------------------------------------------------*/
+NWK_NeighbourEntry_t *NWK_NeighbourFind(uint16_t addr);
+NWK_NeighbourEntry_t *NWK_NeighbourFirst(void);
+NWK_NeighbourEntry_t *NWK_NeighbourNext(NWK_NeighbourEntry_t *entry);
+void NWK_NeighbourRemove(NWK_NeighbourEntry_t *entry);
+uint16_t NWK_NeighbourEtx(uint16_t addr);
+
+void nwkNeighbourInit(void);
+void nwkNeighbourFrameReceived(NwkFrame_t *frame);
+void nwkNeighbourFrameSent(NwkFrame_t *frame);
+void nwkNeighbourAckReceived(uint16_t addr, uint16_t rtt);
+
+#endif /* NWK_ENABLE_NEIGHBOUR_TABLE */
+
+#endif /* _NWK_NEIGHBOUR_H_ */
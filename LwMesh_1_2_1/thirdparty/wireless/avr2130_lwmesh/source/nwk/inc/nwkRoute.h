@@ -72,6 +72,7 @@ uint16_t NWK_RouteNextHop(uint16_t dst, uint8_t multicast);
 NWK_RouteTableEntry_t *NWK_RouteTable(void);
 
 void nwkRouteInit(void);
+NWK_RouteTableEntry_t *nwkRouteNewEntry(uint16_t dst, uint8_t multicast);
 void nwkRouteRemove(uint16_t dst, uint8_t multicast);
 void nwkRouteFrameReceived(NwkFrame_t *frame);
 void nwkRouteFrameSent(NwkFrame_t *frame);
@@ -80,6 +81,13 @@ void nwkRouteFrame(NwkFrame_t *frame);
 bool nwkRouteErrorReceived(NWK_DataInd_t *ind);
 void nwkRouteUpdateEntry(uint16_t dst, uint8_t multicast, uint16_t nextHop,
 		uint8_t lqi);
+#ifdef NWK_ENABLE_EXPANDING_RING
+bool nwkRouteIsFresh(NWK_RouteTableEntry_t *entry);
+#endif
+#ifdef NWK_ENABLE_MULTIPATH
+void nwkRouteAddAlternate(uint16_t dst, uint8_t multicast, uint16_t nextHop,
+		uint8_t lqi);
+#endif
 
 #endif /* NWK_ENABLE_ROUTING */
 
@@ -45,6 +45,9 @@
 #include <stdint.h>
 #include "nwkFrame.h"
 
+/*- Definitions ------------------------------------------------------------*/
+#define NWK_SERVICE_ENDPOINT_ID       0
+
 /*- Types ------------------------------------------------------------------*/
 enum {
 	NWK_IND_OPT_ACK_REQUESTED     = 1 << 0,
@@ -56,6 +59,15 @@ enum {
 	NWK_IND_OPT_MULTICAST         = 1 << 6,
 };
 
+typedef struct NWK_DuplicateRejectionEntry_t {
+	uint16_t src;
+	uint8_t seq;
+	uint8_t mask;
+	uint8_t ackMask;
+	uint8_t ackControl;
+	uint32_t expiry;
+} NWK_DuplicateRejectionEntry_t;
+
 typedef struct NWK_DataInd_t {
 	uint16_t srcAddr;
 	uint16_t dstAddr;
@@ -70,6 +82,8 @@ typedef struct NWK_DataInd_t {
 
 /*- Prototypes -------------------------------------------------------------*/
 void NWK_SetAckControl(uint8_t control);
+void NWK_SetDuplicateRejectionTable(NWK_DuplicateRejectionEntry_t *table,
+		uint16_t size);
 
 #ifdef NWK_ENABLE_ADDRESS_FILTER
 bool NWK_FilterAddress(uint16_t addr, uint8_t *lqi);
@@ -78,6 +92,7 @@ bool NWK_FilterAddress(uint16_t addr, uint8_t *lqi);
 
 void nwkRxInit(void);
 void nwkRxDecryptConf(NwkFrame_t *frame, bool status);
+void nwkRxForgetDuplicate(NwkFrameHeader_t *header);
 void nwkRxTaskHandler(void);
 
 #endif /* _NWK_RX_H_ */
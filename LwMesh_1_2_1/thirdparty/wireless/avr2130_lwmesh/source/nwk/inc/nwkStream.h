@@ -0,0 +1,88 @@
+/**
+ * \file nwkStream.h
+ *
+ * \brief Windowed reliable delivery interface
+ *
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ *
+ */
+
+/*
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+#ifndef _NWK_STREAM_H_
+#define _NWK_STREAM_H_
+
+/*- Includes ---------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "sysConfig.h"
+#include "nwkRx.h"
+
+/*- Definitions ------------------------------------------------------------*/
+#define NWK_STREAM_HEADER_SIZE       5 /* sizeof(NwkCommandStreamData_t) */
+#define NWK_STREAM_MAX_PAYLOAD_SIZE  (NWK_MAX_PAYLOAD_SIZE - \
+	NWK_STREAM_HEADER_SIZE - NWK_SECURITY_MIC_SIZE)
+
+#ifdef NWK_ENABLE_STREAM
+
+/*- Types ------------------------------------------------------------------*/
+typedef struct NWK_StreamReq_t {
+	/* service fields */
+	void *next;
+	void *frame;
+	uint8_t state;
+	uint8_t seq;
+
+	/* request parameters */
+	uint16_t dstAddr;
+	uint8_t dstEndpoint;
+	uint8_t srcEndpoint;
+	uint8_t options;
+	uint8_t *data;
+	uint8_t size;
+	void (*confirm)(struct NWK_StreamReq_t *req);
+
+	/* confirmation parameters */
+	uint8_t status;
+} NWK_StreamReq_t;
+
+/*- Prototypes -------------------------------------------------------------*/
+void NWK_StreamReq(NWK_StreamReq_t *req);
+
+void nwkStreamInit(void);
+bool nwkStreamDataReceived(NWK_DataInd_t *ind);
+bool nwkStreamAckReceived(NWK_DataInd_t *ind);
+void nwkStreamTaskHandler(void);
+
+#endif /* NWK_ENABLE_STREAM */
+
+#endif /* _NWK_STREAM_H_ */
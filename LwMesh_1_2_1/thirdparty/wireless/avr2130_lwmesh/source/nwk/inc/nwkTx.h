@@ -51,12 +51,32 @@ enum {
 	NWK_TX_CONTROL_BROADCAST_PAN_ID = 1 << 0,
 	NWK_TX_CONTROL_ROUTING          = 1 << 1,
 	NWK_TX_CONTROL_DIRECT_LINK      = 1 << 2,
+	NWK_TX_CONTROL_RETRY            = 1 << 3,
+	NWK_TX_CONTROL_REBROADCAST      = 1 << 4,
 };
 
+#ifdef NWK_ENABLE_ADAPTIVE_ACK_WAIT
+typedef struct NWK_RttTableEntry_t {
+	uint16_t dstAddr;
+	uint16_t srtt;
+	uint16_t rttvar;
+} NWK_RttTableEntry_t;
+#endif
+
 /*- Prototypes -------------------------------------------------------------*/
+uint16_t NWK_AckWaitTime(uint16_t dstAddr);
+
+#ifdef NWK_ENABLE_ADAPTIVE_ACK_WAIT
+NWK_RttTableEntry_t *NWK_RttTable(void);
+
+#endif
+
 void nwkTxInit(void);
 void nwkTxFrame(NwkFrame_t *frame);
 void nwkTxBroadcastFrame(NwkFrame_t *frame);
+#ifdef NWK_ENABLE_BROADCAST_SUPPRESSION
+void nwkTxBroadcastOverheard(NwkFrameHeader_t *header);
+#endif
 bool nwkTxAckReceived(NWK_DataInd_t *ind);
 void nwkTxConfirm(NwkFrame_t *frame, uint8_t status);
 void nwkTxEncryptConf(NwkFrame_t *frame);
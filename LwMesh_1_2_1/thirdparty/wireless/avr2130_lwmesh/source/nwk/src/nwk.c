@@ -52,6 +52,8 @@
 #include "nwkRoute.h"
 #include "nwkSecurity.h"
 #include "nwkRouteDiscovery.h"
+#include "nwkFrag.h"
+#include "nwkStream.h"
 
 /*- Variables --------------------------------------------------------------*/
 NwkIb_t nwkIb;
@@ -81,6 +83,10 @@ void NWK_Init(void)
 	nwkRouteInit();
 #endif
 
+#ifdef NWK_ENABLE_NEIGHBOUR_TABLE
+	nwkNeighbourInit();
+#endif
+
 #ifdef NWK_ENABLE_SECURITY
 	nwkSecurityInit();
 #endif
@@ -92,6 +98,14 @@ void NWK_Init(void)
 #ifdef NWK_ENABLE_ROUTE_DISCOVERY
 	nwkRouteDiscoveryInit();
 #endif
+
+#ifdef NWK_ENABLE_FRAGMENTATION
+	nwkFragInit();
+#endif
+
+#ifdef NWK_ENABLE_STREAM
+	nwkStreamInit();
+#endif
 }
 
 /*************************************************************************//**
@@ -194,6 +208,12 @@ void NWK_TaskHandler(void)
 	nwkRxTaskHandler();
 	nwkTxTaskHandler();
 	nwkDataReqTaskHandler();
+#ifdef NWK_ENABLE_FRAGMENTATION
+	nwkFragTaskHandler();
+#endif
+#ifdef NWK_ENABLE_STREAM
+	nwkStreamTaskHandler();
+#endif
 #ifdef NWK_ENABLE_SECURITY
 	nwkSecurityTaskHandler();
 #endif
@@ -44,6 +44,7 @@
 #include <stdbool.h>
 #include <string.h>
 #include "sysConfig.h"
+#include "sysTimer.h"
 #include "nwk.h"
 #include "nwkTx.h"
 #include "nwkFrame.h"
@@ -58,10 +59,31 @@ enum {
 };
 
 /*- Prototypes -------------------------------------------------------------*/
+static void nwkDataReqQueueAdd(NWK_DataReq_t *req);
+static void nwkDataReqCopy(NWK_DataReq_t *req, uint8_t *data);
+static bool nwkDataReqSendFrame(NWK_DataReq_t *req);
 static void nwkDataReqTxConf(NwkFrame_t *frame);
+static void nwkDataReqConfirm(NWK_DataReq_t *req);
+static void nwkDataReqCheckCredits(void);
+#ifdef NWK_ENABLE_AGGREGATION
+static bool nwkDataReqCanAggregate(NWK_DataReq_t *req);
+static uint8_t nwkDataReqAggregate(NWK_DataReq_t *req, NwkFrame_t *frame);
+static uint8_t nwkDataReqAggregateAdd(NWK_DataReq_t *req, NwkFrame_t *frame,
+		uint8_t offset);
+static void nwkDataReqHoldTimerHandler(SYS_Timer_t *timer);
+#endif
 
 /*- Variables --------------------------------------------------------------*/
 static NWK_DataReq_t *nwkDataReqQueue;
+static NWK_DataReq_t *nwkDataReqQueueTail;
+static uint8_t nwkDataReqHighAmount;
+static void (*nwkDataReqCreditHandler)(uint8_t credits);
+static uint8_t nwkDataReqCreditWatermark;
+static bool nwkDataReqCreditLow;
+#ifdef NWK_ENABLE_AGGREGATION
+static SYS_Timer_t nwkDataReqHoldTimer;
+static bool nwkDataReqHoldExpired;
+#endif
 
 /*- Implementations --------------------------------------------------------*/
 
@@ -71,52 +93,249 @@ static NWK_DataReq_t *nwkDataReqQueue;
 void nwkDataReqInit(void)
 {
 	nwkDataReqQueue = NULL;
+	nwkDataReqQueueTail = NULL;
+	nwkDataReqHighAmount = 0;
+	nwkDataReqCreditHandler = NULL;
+
+#ifdef NWK_ENABLE_AGGREGATION
+	nwkDataReqHoldExpired = false;
+	nwkDataReqHoldTimer.interval = NWK_AGGREGATION_HOLD_TIME;
+	nwkDataReqHoldTimer.mode = SYS_TIMER_INTERVAL_MODE;
+	nwkDataReqHoldTimer.handler = nwkDataReqHoldTimerHandler;
+#endif
 }
 
 /*************************************************************************//**
-*  @brief Adds request @a req to the queue of outgoing requests
+*  @brief Adds request @a req to the end of the queue of outgoing requests
 *  @param[in] req Pointer to the request parameters
 *****************************************************************************/
 void NWK_DataReq(NWK_DataReq_t *req)
+{
+	req->frame = NULL;
+	req->segments = NULL;
+	nwkDataReqQueueAdd(req);
+}
+
+/*************************************************************************//**
+*  @brief Adds request @a req with the payload gathered from several buffers
+*  @param[in] req Pointer to the request parameters
+*  @param[in] segments Pointer to the list of payload segments
+*  @param[in] amount Number of segments in the list
+*
+*  The segments are copied into the frame one after another when the frame is
+*  sent, so the list and the buffers must stay valid until the confirmation.
+*  The @a data and @a size fields of the request are ignored, @a size is set
+*  to the total size of the payload.
+*****************************************************************************/
+void NWK_DataReqGather(NWK_DataReq_t *req, NWK_DataSegment_t *segments,
+		uint8_t amount)
+{
+	uint16_t size = 0;
+
+	for (uint8_t i = 0; i < amount; i++) {
+		size += segments[i].size;
+	}
+
+	req->frame = NULL;
+	req->segments = segments;
+	req->segmentsAmount = amount;
+	req->size = size;
+	nwkDataReqQueueAdd(req);
+
+	if (size > NWK_MAX_PAYLOAD_SIZE) {
+		req->state = NWK_DATA_REQ_STATE_CONFIRM;
+		req->status = NWK_ERROR_STATUS;
+	}
+}
+
+/*************************************************************************//**
+*  @brief Reserves a frame for the request @a req and returns its payload
+*  @param[in] req Pointer to the request parameters
+*  @param[in] size Maximum size of the payload
+*  @return Pointer to the payload area of the frame or @c NULL if there are
+*  no free frames
+*
+*  The application builds the payload directly in the returned area and
+*  passes the request to NWK_DataReqCommit(), so the payload is not copied.
+*  The @a options field must be set before the call and @a size set later in
+*  the request must not exceed the reserved size. Reserved requests are never
+*  aggregated. NWK_DataReqRelease() returns the frame if the payload is not
+*  going to be sent.
+*****************************************************************************/
+uint8_t *NWK_DataReqReserve(NWK_DataReq_t *req, uint8_t size)
+{
+	NwkFrame_t *frame;
+
+#ifdef NWK_ENABLE_MULTICAST
+	if (req->options & NWK_OPT_MULTICAST) {
+		size += sizeof(NwkFrameMulticastHeader_t);
+	}
+#endif
+
+	if (NULL == (frame = nwkFrameAlloc(NWK_FRAME_CLASS_DATA, size))) {
+		return NULL;
+	}
+
+#ifdef NWK_ENABLE_MULTICAST
+	if (req->options & NWK_OPT_MULTICAST) {
+		frame->payload += sizeof(NwkFrameMulticastHeader_t);
+	}
+#endif
+
+	req->frame = frame;
+	return frame->payload;
+}
+
+/*************************************************************************//**
+*  @brief Adds request @a req with the payload placed into the frame reserved
+*  by NWK_DataReqReserve() to the end of the queue of outgoing requests
+*  @param[in] req Pointer to the request parameters
+*****************************************************************************/
+void NWK_DataReqCommit(NWK_DataReq_t *req)
+{
+	req->segments = NULL;
+	nwkDataReqQueueAdd(req);
+}
+
+/*************************************************************************//**
+*  @brief Returns the frame reserved by NWK_DataReqReserve() without sending
+*  @param[in] req Pointer to the request parameters
+*****************************************************************************/
+void NWK_DataReqRelease(NWK_DataReq_t *req)
+{
+	nwkFrameFree(req->frame);
+	req->frame = NULL;
+}
+
+/*************************************************************************//**
+*  @brief Returns the number of data requests that can be sent right away
+*  @return Number of free frames for data requests minus the number of queued
+*  requests still waiting for a frame
+*
+*  Small frames are not counted, so the value is a lower bound. A request
+*  queued while there are no credits is likely to be confirmed with
+*  NWK_OUT_OF_MEMORY_STATUS.
+*****************************************************************************/
+uint8_t NWK_DataReqCredits(void)
+{
+	uint8_t credits = nwkFrameAvailable(NWK_FRAME_CLASS_DATA);
+
+	for (NWK_DataReq_t *req = nwkDataReqQueue; req && credits;
+			req = req->next) {
+		if (NWK_DATA_REQ_STATE_INITIAL == req->state && NULL == req->frame) {
+			credits--;
+		}
+	}
+
+	return credits;
+}
+
+/*************************************************************************//**
+*  @brief Registers a callback for the return of the data request credits
+*  @param[in] watermark Number of credits that triggers the callback
+*  @param[in] handler Pointer to the callback function or @c NULL to remove
+*  the callback
+*
+*  The @a handler is called from the task handler with the current number of
+*  credits each time the credits rise from below @a watermark to
+*  @a watermark or above. New requests may be queued from the callback.
+*****************************************************************************/
+void NWK_DataReqSetCreditHandler(uint8_t watermark,
+		void (*handler)(uint8_t credits))
+{
+	nwkDataReqCreditWatermark = watermark;
+	nwkDataReqCreditHandler = handler;
+	nwkDataReqCreditLow = NWK_DataReqCredits() < watermark;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static void nwkDataReqCheckCredits(void)
+{
+	uint8_t credits = NWK_DataReqCredits();
+
+	if (credits < nwkDataReqCreditWatermark) {
+		nwkDataReqCreditLow = true;
+	} else if (nwkDataReqCreditLow) {
+		nwkDataReqCreditLow = false;
+		nwkDataReqCreditHandler(credits);
+	}
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static void nwkDataReqQueueAdd(NWK_DataReq_t *req)
 {
 	req->state = NWK_DATA_REQ_STATE_INITIAL;
 	req->status = NWK_SUCCESS_STATUS;
-	req->frame = NULL;
+	req->attempts = 0;
+	req->next = NULL;
+	req->prev = nwkDataReqQueueTail;
 
 	nwkIb.lock++;
 
-	if (NULL == nwkDataReqQueue) {
-		req->next = NULL;
+	if (NWK_PRIORITY_HIGH == req->priority) {
+		nwkDataReqHighAmount++;
+	}
+
+	if (NULL == nwkDataReqQueueTail) {
 		nwkDataReqQueue = req;
 	} else {
-		req->next = nwkDataReqQueue;
-		nwkDataReqQueue = req;
+		nwkDataReqQueueTail->next = req;
 	}
+
+	nwkDataReqQueueTail = req;
 }
 
 /*************************************************************************//**
 *  @brief Prepares and send outgoing frame based on the request @a req
 * parameters
 *  @param[in] req Pointer to the request parameters
+*  @return @c false if there was no free frame, @c true otherwise
 *****************************************************************************/
-static void nwkDataReqSendFrame(NWK_DataReq_t *req)
+static bool nwkDataReqSendFrame(NWK_DataReq_t *req)
 {
-	NwkFrame_t *frame;
+	NwkFrame_t *frame = req->frame;
+	bool reserved = (NULL != frame);
+	uint8_t size = req->size;
+#ifdef NWK_ENABLE_AGGREGATION
+	uint8_t aggregateSize = 0;
+
+	if (nwkDataReqCanAggregate(req)) {
+		aggregateSize = nwkDataReqAggregate(req, NULL);
+	}
+
+	if (aggregateSize) {
+		size = aggregateSize;
+	}
+#endif
+
+#ifdef NWK_ENABLE_MULTICAST
+	if (req->options & NWK_OPT_MULTICAST) {
+		size += sizeof(NwkFrameMulticastHeader_t);
+	}
+#endif
 
-	if (NULL == (frame = nwkFrameAlloc())) {
+	if (!reserved && NULL == (frame = nwkFrameAlloc(NWK_FRAME_CLASS_DATA,
+			size))) {
 		req->state = NWK_DATA_REQ_STATE_CONFIRM;
 		req->status = NWK_OUT_OF_MEMORY_STATUS;
-		return;
+		return false;
 	}
 
 	req->frame = frame;
 	req->state = NWK_DATA_REQ_STATE_WAIT_CONF;
 
+	frame->tx.owner = req;
 	frame->tx.confirm = nwkDataReqTxConf;
 	frame->tx.control = req->options &
 			NWK_OPT_BROADCAST_PAN_ID ?
 			NWK_TX_CONTROL_BROADCAST_PAN_ID
 			: 0;
+	frame->tx.control |= req->options &
+			NWK_OPT_RETRY ? NWK_TX_CONTROL_RETRY : 0;
+	frame->tx.priority = req->priority < NWK_PRIORITIES_AMOUNT ?
+			req->priority : NWK_PRIORITY_NORMAL;
 
 	frame->header.nwkFcf.ackRequest = req->options &
 			NWK_OPT_ACK_REQUEST ? 1 : 0;
@@ -134,14 +353,15 @@ static void nwkDataReqSendFrame(NWK_DataReq_t *req)
 
 	if (frame->header.nwkFcf.multicast) {
 		NwkFrameMulticastHeader_t *mcHeader
-			= (NwkFrameMulticastHeader_t *)frame->payload;
+			= (NwkFrameMulticastHeader_t *)(frame->data +
+				sizeof(NwkFrameHeader_t));
 
 		mcHeader->memberRadius = req->memberRadius;
 		mcHeader->maxMemberRadius = req->memberRadius;
 		mcHeader->nonMemberRadius = req->nonMemberRadius;
 		mcHeader->maxNonMemberRadius = req->nonMemberRadius;
 
-		frame->payload += sizeof(NwkFrameMulticastHeader_t);
+		frame->payload = (uint8_t *)(mcHeader + 1);
 		frame->size += sizeof(NwkFrameMulticastHeader_t);
 	}
 #endif
@@ -152,24 +372,66 @@ static void nwkDataReqSendFrame(NWK_DataReq_t *req)
 	frame->header.nwkSrcEndpoint = req->srcEndpoint;
 	frame->header.nwkDstEndpoint = req->dstEndpoint;
 
-	memcpy(frame->payload, req->data, req->size);
-	frame->size += req->size;
+#ifdef NWK_ENABLE_AGGREGATION
+	if (aggregateSize) {
+		frame->header.nwkFcf.aggregate = 1;
+		nwkDataReqAggregate(req, frame);
+	} else
+#endif
+	{
+		if (!reserved) {
+			nwkDataReqCopy(req, frame->payload);
+		}
+
+		frame->size += req->size;
+	}
 
 	nwkTxFrame(frame);
+	return true;
+}
+
+/*************************************************************************//**
+*  @brief Copies the payload of the request @a req to @a data
+*****************************************************************************/
+static void nwkDataReqCopy(NWK_DataReq_t *req, uint8_t *data)
+{
+	if (NULL == req->segments) {
+		memcpy(data, req->data, req->size);
+		return;
+	}
+
+	for (uint8_t i = 0; i < req->segmentsAmount; i++) {
+		memcpy(data, req->segments[i].data, req->segments[i].size);
+		data += req->segments[i].size;
+	}
 }
 
 /*************************************************************************//**
 *  @brief Frame transmission confirmation handler
 *  @param[in] frame Pointer to the sent frame
+*
+*  The request is found through the frame owner pointer. All requests
+*  aggregated into the @a frame are confirmed with its status, they are
+*  looked up in the queue.
 *****************************************************************************/
 static void nwkDataReqTxConf(NwkFrame_t *frame)
 {
-	for (NWK_DataReq_t *req = nwkDataReqQueue; req; req = req->next) {
+	NWK_DataReq_t *req = frame->tx.owner;
+	NWK_DataReq_t *last = req->next;
+
+#ifdef NWK_ENABLE_AGGREGATION
+	if (frame->header.nwkFcf.aggregate) {
+		req = nwkDataReqQueue;
+		last = NULL;
+	}
+#endif
+
+	for (; req != last; req = req->next) {
 		if (req->frame == frame) {
 			req->status = frame->tx.status;
 			req->control = frame->tx.control;
+			req->attempts = frame->tx.attempts;
 			req->state = NWK_DATA_REQ_STATE_CONFIRM;
-			break;
 		}
 	}
 
@@ -182,14 +444,23 @@ static void nwkDataReqTxConf(NwkFrame_t *frame)
 *****************************************************************************/
 static void nwkDataReqConfirm(NWK_DataReq_t *req)
 {
-	if (nwkDataReqQueue == req) {
-		nwkDataReqQueue = nwkDataReqQueue->next;
+	NWK_DataReq_t *prev = req->prev;
+	NWK_DataReq_t *next = req->next;
+
+	if (prev) {
+		prev->next = next;
 	} else {
-		NWK_DataReq_t *prev = nwkDataReqQueue;
-		while (prev->next != req) {
-			prev = prev->next;
-		}
-		prev->next = ((NWK_DataReq_t *)prev->next)->next;
+		nwkDataReqQueue = next;
+	}
+
+	if (next) {
+		next->prev = prev;
+	} else {
+		nwkDataReqQueueTail = prev;
+	}
+
+	if (NWK_PRIORITY_HIGH == req->priority) {
+		nwkDataReqHighAmount--;
 	}
 
 	nwkIb.lock--;
@@ -198,15 +469,55 @@ static void nwkDataReqConfirm(NWK_DataReq_t *req)
 
 /*************************************************************************//**
 *  @brief Data Request module task handler
+*
+*  Requests are served in the order they were queued, up to
+*  NWK_DATA_REQ_BUDGET sent or confirmed requests per call. High priority
+*  requests are sent first, so that they get the free frames. No more
+*  requests are sent in the same call once a frame allocation fails.
 *****************************************************************************/
 void nwkDataReqTaskHandler(void)
 {
-	for (NWK_DataReq_t *req = nwkDataReqQueue; req; req = req->next) {
+	NWK_DataReq_t *req, *next;
+	uint8_t budget = NWK_DATA_REQ_BUDGET;
+	bool allocate = true;
+#ifdef NWK_ENABLE_AGGREGATION
+	bool held = false;
+#endif
+
+	/* Most queues hold no high priority requests, skip the extra walk */
+	for (req = nwkDataReqHighAmount ? nwkDataReqQueue : NULL;
+			req && budget && allocate; req = req->next) {
+		if (NWK_DATA_REQ_STATE_INITIAL == req->state &&
+				NWK_PRIORITY_HIGH == req->priority
+#ifdef NWK_ENABLE_AGGREGATION
+				&& !nwkDataReqCanAggregate(req)
+#endif
+				) {
+			allocate = nwkDataReqSendFrame(req);
+			budget--;
+		}
+	}
+
+	for (req = nwkDataReqQueue; req && budget; req = next) {
+		next = req->next;
+
 		switch (req->state) {
 		case NWK_DATA_REQ_STATE_INITIAL:
 		{
-			nwkDataReqSendFrame(req);
-			return;
+#ifdef NWK_ENABLE_AGGREGATION
+			if (nwkDataReqCanAggregate(req)) {
+				held = true;
+
+				if (!nwkDataReqHoldExpired) {
+					break;
+				}
+			}
+#endif
+
+			if (allocate) {
+				allocate = nwkDataReqSendFrame(req);
+				budget--;
+			}
 		}
 		break;
 
@@ -216,7 +527,7 @@ void nwkDataReqTaskHandler(void)
 		case NWK_DATA_REQ_STATE_CONFIRM:
 		{
 			nwkDataReqConfirm(req);
-			return;
+			budget--;
 		}
 		break;
 
@@ -224,4 +535,129 @@ void nwkDataReqTaskHandler(void)
 			break;
 		}
 	}
+
+	if (nwkDataReqCreditHandler) {
+		nwkDataReqCheckCredits();
+	}
+
+#ifdef NWK_ENABLE_AGGREGATION
+	/* The hold state is only known after a full pass over the queue */
+	if (req) {
+		return;
+	}
+
+	if (!held) {
+		nwkDataReqHoldExpired = false;
+	} else if (!nwkDataReqHoldExpired &&
+			!SYS_TimerStarted(&nwkDataReqHoldTimer)) {
+		SYS_TimerStart(&nwkDataReqHoldTimer);
+	}
+#endif
 }
+
+#ifdef NWK_ENABLE_AGGREGATION
+
+/*************************************************************************//**
+*  @brief Checks if the request @a req may be aggregated with other requests
+*  @param[in] req Pointer to the request parameters
+*  @return @c true if the request may be aggregated, @c false otherwise
+*****************************************************************************/
+static bool nwkDataReqCanAggregate(NWK_DataReq_t *req)
+{
+	return (req->options & NWK_OPT_AGGREGATE) &&
+			0 == (req->options & NWK_OPT_MULTICAST) &&
+			NULL == req->frame;
+}
+
+/*************************************************************************//**
+*  @brief Collects waiting requests to the same destination as @a req
+*  @param[in] req Pointer to the request that is being sent
+*  @param[in] frame Pointer to the frame to place the payloads into or
+*  @c NULL to only calculate the size
+*  @return Size of the aggregated payload or 0 if there are no requests to
+*  aggregate with @a req
+*
+*  Requests are aggregated when they have the same destination address,
+*  options and priority. Each payload is preceded by its endpoints and size.
+*****************************************************************************/
+static uint8_t nwkDataReqAggregate(NWK_DataReq_t *req, NwkFrame_t *frame)
+{
+	uint8_t capacity = NWK_MAX_PAYLOAD_SIZE;
+	uint8_t size;
+	uint8_t amount = 1;
+
+#ifdef NWK_ENABLE_SECURITY
+	if (req->options & NWK_OPT_ENABLE_SECURITY) {
+		capacity -= NWK_SECURITY_MIC_SIZE;
+	}
+#endif
+
+	if (sizeof(NwkFrameAggregateHeader_t) + req->size > capacity) {
+		return 0;
+	}
+
+	size = nwkDataReqAggregateAdd(req, frame, 0);
+
+	for (NWK_DataReq_t *r = nwkDataReqQueue; r; r = r->next) {
+		if (r == req || NWK_DATA_REQ_STATE_INITIAL != r->state ||
+				!nwkDataReqCanAggregate(r) ||
+				r->dstAddr != req->dstAddr ||
+				r->options != req->options ||
+				r->priority != req->priority) {
+			continue;
+		}
+
+		if (size + sizeof(NwkFrameAggregateHeader_t) + r->size > capacity) {
+			continue;
+		}
+
+		size = nwkDataReqAggregateAdd(r, frame, size);
+		amount++;
+	}
+
+	if (amount < 2) {
+		return 0;
+	}
+
+	if (frame) {
+		frame->size += size;
+	}
+
+	return size;
+}
+
+/*************************************************************************//**
+*  @brief Places the payload of the request @a req into the aggregated @a frame
+*  @param[in] req Pointer to the request parameters
+*  @param[in] frame Pointer to the frame or @c NULL to only calculate the size
+*  @param[in] offset Offset of the payload in the frame
+*  @return Offset of the next payload
+*****************************************************************************/
+static uint8_t nwkDataReqAggregateAdd(NWK_DataReq_t *req, NwkFrame_t *frame,
+		uint8_t offset)
+{
+	if (frame) {
+		NwkFrameAggregateHeader_t *header
+			= (NwkFrameAggregateHeader_t *)(frame->payload + offset);
+
+		header->srcEndpoint = req->srcEndpoint;
+		header->dstEndpoint = req->dstEndpoint;
+		header->size = req->size;
+		nwkDataReqCopy(req, (uint8_t *)(header + 1));
+
+		req->frame = frame;
+		req->state = NWK_DATA_REQ_STATE_WAIT_CONF;
+	}
+
+	return offset + sizeof(NwkFrameAggregateHeader_t) + req->size;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static void nwkDataReqHoldTimerHandler(SYS_Timer_t *timer)
+{
+	nwkDataReqHoldExpired = true;
+	(void)timer;
+}
+
+#endif /* NWK_ENABLE_AGGREGATION */
@@ -0,0 +1,536 @@
+/**
+ * \file nwkFrag.c
+ *
+ * \brief Fragmentation of large payloads implementation
+ *
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ *
+ */
+
+/*
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/*- Includes ---------------------------------------------------------------*/
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "sysTimer.h"
+#include "sysConfig.h"
+#include "nwk.h"
+#include "nwkTx.h"
+#include "nwkFrame.h"
+#include "nwkCommand.h"
+#include "nwkFrag.h"
+
+#ifdef NWK_ENABLE_FRAGMENTATION
+
+/*- Types ------------------------------------------------------------------*/
+enum {
+	NWK_FRAG_REQ_STATE_SEND,
+	NWK_FRAG_REQ_STATE_WAIT_ACK,
+	NWK_FRAG_REQ_STATE_CONFIRM,
+};
+
+enum {
+	NWK_FRAG_RX_STATE_IDLE,
+	NWK_FRAG_RX_STATE_RECEIVE,
+	NWK_FRAG_RX_STATE_DONE,
+};
+
+typedef struct NwkFragRx_t {
+	uint8_t *buffer;
+	uint16_t size;
+	void (*handler)(NWK_FragInd_t *ind);
+
+	uint8_t state;
+	uint8_t seq;
+	uint8_t received[NWK_FRAG_BITMAP_SIZE];
+	NWK_FragInd_t ind;
+} NwkFragRx_t;
+
+/* Fails to compile if NWK_FRAG_HEADER_SIZE does not match the command */
+typedef char nwkFragHeaderSizeCheck_t[(NWK_FRAG_HEADER_SIZE ==
+		sizeof(NwkCommandFragment_t)) ? 1 : -1];
+
+/*- Prototypes -------------------------------------------------------------*/
+static uint8_t nwkFragAmount(uint16_t size);
+static uint8_t nwkFragNextMissing(uint8_t *bitmap, uint8_t index,
+		uint8_t amount);
+static bool nwkFragSendFragment(NWK_FragReq_t *req, uint8_t index,
+		bool last);
+static void nwkFragSendAck(uint16_t dst, uint8_t seq, uint8_t status,
+		bool secured);
+static void nwkFragTxConf(NwkFrame_t *frame);
+static void nwkFragAckTimerHandler(SYS_Timer_t *timer);
+static void nwkFragRxTimerHandler(SYS_Timer_t *timer);
+
+/*- Variables --------------------------------------------------------------*/
+static NWK_FragReq_t *nwkFragReqQueue;
+static uint8_t nwkFragSeqNum;
+static SYS_Timer_t nwkFragAckTimer;
+static NwkFragRx_t nwkFragRx;
+static SYS_Timer_t nwkFragRxTimer;
+
+/*- Implementations --------------------------------------------------------*/
+
+/*************************************************************************//**
+*  @brief Initializes the Fragmentation module
+*****************************************************************************/
+void nwkFragInit(void)
+{
+	nwkFragReqQueue = NULL;
+	nwkFragSeqNum = 0;
+
+	nwkFragRx.buffer = NULL;
+	nwkFragRx.size = 0;
+	nwkFragRx.handler = NULL;
+	nwkFragRx.state = NWK_FRAG_RX_STATE_IDLE;
+
+	nwkFragAckTimer.interval = NWK_FRAG_ACK_WAIT_TIME;
+	nwkFragAckTimer.mode = SYS_TIMER_INTERVAL_MODE;
+	nwkFragAckTimer.handler = nwkFragAckTimerHandler;
+
+	nwkFragRxTimer.interval = NWK_FRAG_RX_TIMEOUT;
+	nwkFragRxTimer.mode = SYS_TIMER_INTERVAL_MODE;
+	nwkFragRxTimer.handler = nwkFragRxTimerHandler;
+}
+
+/*************************************************************************//**
+*  @brief Adds request @a req to the queue of outgoing fragmented transfers
+*  @param[in] req Pointer to the request parameters
+*
+*  The payload is split into fragments of NWK_FRAG_FRAGMENT_SIZE bytes. Up to
+*  NWK_FRAG_WINDOW fragments are passed to the Tx module at a time and the
+*  last fragment of each round requests a selective acknowledgement, missing
+*  fragments are sent again in the next round. Transfers are served one at
+*  a time in the order of the requests.
+*****************************************************************************/
+void NWK_FragReq(NWK_FragReq_t *req)
+{
+	req->state = NWK_FRAG_REQ_STATE_SEND;
+	req->status = NWK_SUCCESS_STATUS;
+	req->seq = ++nwkFragSeqNum;
+	req->index = 0;
+	req->frames = 0;
+	req->attempts = 0;
+	req->next = NULL;
+	memset(req->acked, 0, sizeof(req->acked));
+
+	if (0 == req->size || req->size > NWK_FRAG_MAX_SIZE) {
+		req->state = NWK_FRAG_REQ_STATE_CONFIRM;
+		req->status = NWK_ERROR_STATUS;
+	}
+
+	nwkIb.lock++;
+
+	if (NULL == nwkFragReqQueue) {
+		nwkFragReqQueue = req;
+	} else {
+		NWK_FragReq_t *last = nwkFragReqQueue;
+
+		while (last->next) {
+			last = last->next;
+		}
+
+		last->next = req;
+	}
+}
+
+/*************************************************************************//**
+*  @brief Sets the buffer for reassembly of the incoming transfers
+*  @param[in] buffer Pointer to the buffer
+*  @param[in] size Size of the buffer
+*  @param[in] handler Pointer to the function called for every received
+*  transfer
+*
+*  Transfers larger than the buffer are rejected. The buffer is reused for the
+*  next transfer once the @a handler returns.
+*****************************************************************************/
+void NWK_FragSetRxBuffer(uint8_t *buffer, uint16_t size,
+		void (*handler)(NWK_FragInd_t *ind))
+{
+	nwkFragRx.buffer = buffer;
+	nwkFragRx.size = size;
+	nwkFragRx.handler = handler;
+	nwkFragRx.state = NWK_FRAG_RX_STATE_IDLE;
+	SYS_TimerStop(&nwkFragRxTimer);
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static uint8_t nwkFragAmount(uint16_t size)
+{
+	return (size + NWK_FRAG_FRAGMENT_SIZE - 1) / NWK_FRAG_FRAGMENT_SIZE;
+}
+
+/*************************************************************************//**
+*  @brief Finds the first fragment not marked in the @a bitmap
+*  @param[in] bitmap Pointer to the fragment bitmap
+*  @param[in] index Index of the fragment to start from
+*  @param[in] amount Total number of fragments
+*  @return Index of the fragment or @a amount if all fragments are marked
+*****************************************************************************/
+static uint8_t nwkFragNextMissing(uint8_t *bitmap, uint8_t index,
+		uint8_t amount)
+{
+	while (index < amount && (bitmap[index / 8] & (1 << (index % 8)))) {
+		index++;
+	}
+
+	return index;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static bool nwkFragSendFragment(NWK_FragReq_t *req, uint8_t index,
+		bool last)
+{
+	NwkFrame_t *frame;
+	NwkCommandFragment_t *command;
+	uint16_t offset = (uint16_t)index * NWK_FRAG_FRAGMENT_SIZE;
+	uint8_t size = NWK_FRAG_FRAGMENT_SIZE;
+
+	if ((req->size - offset) < NWK_FRAG_FRAGMENT_SIZE) {
+		size = req->size - offset;
+	}
+
+	if (NULL == (frame = nwkFrameAlloc(NWK_FRAME_CLASS_DATA,
+			sizeof(NwkCommandFragment_t) + size))) {
+		return false;
+	}
+
+	frame->tx.confirm = nwkFragTxConf;
+	frame->tx.control = req->options & NWK_OPT_RETRY ?
+			NWK_TX_CONTROL_RETRY : 0;
+	frame->tx.priority = NWK_PRIORITY_NORMAL;
+
+#ifdef NWK_ENABLE_SECURE_COMMANDS
+	frame->header.nwkFcf.security = 1;
+#elif defined(NWK_ENABLE_SECURITY)
+	frame->header.nwkFcf.security = req->options &
+			NWK_OPT_ENABLE_SECURITY ? 1 : 0;
+#endif
+
+	frame->header.nwkSeq = ++nwkIb.nwkSeqNum;
+	frame->header.nwkSrcAddr = nwkIb.addr;
+	frame->header.nwkDstAddr = req->dstAddr;
+
+	command = (NwkCommandFragment_t *)frame->payload;
+	command->id = NWK_COMMAND_FRAGMENT;
+	command->seq = req->seq;
+	command->index = index;
+	command->control = last ? NWK_COMMAND_FRAGMENT_ACK_REQUEST : 0;
+	command->srcEndpoint = req->srcEndpoint;
+	command->dstEndpoint = req->dstEndpoint;
+	command->size = req->size;
+
+	memcpy(frame->payload + sizeof(NwkCommandFragment_t),
+			req->data + offset, size);
+	frame->size += sizeof(NwkCommandFragment_t) + size;
+
+	req->frames++;
+	nwkTxFrame(frame);
+
+	return true;
+}
+
+/*************************************************************************//**
+*  @brief Fragment transmission confirmation handler
+*  @param[in] frame Pointer to the sent frame
+*
+*  Transmission failures are not handled here, the fragments that did not
+*  make it are reported missing by the receiver.
+*****************************************************************************/
+static void nwkFragTxConf(NwkFrame_t *frame)
+{
+	NWK_FragReq_t *req = nwkFragReqQueue;
+
+	nwkFrameFree(frame);
+	req->frames--;
+
+	if (NWK_FRAG_REQ_STATE_SEND == req->state && 0 == req->frames &&
+			req->index == nwkFragAmount(req->size)) {
+		req->state = NWK_FRAG_REQ_STATE_WAIT_ACK;
+		SYS_TimerStart(&nwkFragAckTimer);
+	}
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+bool nwkFragAckReceived(NWK_DataInd_t *ind)
+{
+	NwkCommandFragmentAck_t *command = (NwkCommandFragmentAck_t *)ind->data;
+	NWK_FragReq_t *req = nwkFragReqQueue;
+	uint8_t amount;
+	bool progress = false;
+
+	if (sizeof(NwkCommandFragmentAck_t) != ind->size) {
+		return false;
+	}
+
+	if (NULL == req || NWK_FRAG_REQ_STATE_CONFIRM == req->state ||
+			req->seq != command->seq || req->dstAddr != ind->srcAddr) {
+		return true;
+	}
+
+	SYS_TimerStop(&nwkFragAckTimer);
+
+	if (NWK_SUCCESS_STATUS != command->status) {
+		req->status = command->status;
+		req->state = NWK_FRAG_REQ_STATE_CONFIRM;
+		return true;
+	}
+
+	for (uint8_t i = 0; i < NWK_FRAG_BITMAP_SIZE; i++) {
+		if (command->bitmap[i] & ~req->acked[i]) {
+			progress = true;
+		}
+
+		req->acked[i] |= command->bitmap[i];
+	}
+
+	if (progress) {
+		req->attempts = 0;
+	}
+
+	amount = nwkFragAmount(req->size);
+
+	if (amount == nwkFragNextMissing(req->acked, 0, amount)) {
+		req->state = NWK_FRAG_REQ_STATE_CONFIRM;
+	} else if (NWK_FRAG_REQ_STATE_WAIT_ACK == req->state) {
+		req->index = 0;
+		req->state = NWK_FRAG_REQ_STATE_SEND;
+	}
+
+	return true;
+}
+
+/*************************************************************************//**
+*  @brief Selective acknowledgement wait timer handler
+*  @param[in] timer Pointer to the timer
+*
+*  Only the last missing fragment is sent again to request a new
+*  acknowledgement, the rest is sent once the receiver reports it missing.
+*****************************************************************************/
+static void nwkFragAckTimerHandler(SYS_Timer_t *timer)
+{
+	NWK_FragReq_t *req = nwkFragReqQueue;
+	uint8_t amount = nwkFragAmount(req->size);
+
+	if (++req->attempts > NWK_FRAG_RETRY_AMOUNT) {
+		req->status = NWK_NO_ACK_STATUS;
+		req->state = NWK_FRAG_REQ_STATE_CONFIRM;
+		return;
+	}
+
+	req->index = amount;
+
+	for (uint8_t i = 0; i < amount; i++) {
+		if (0 == (req->acked[i / 8] & (1 << (i % 8)))) {
+			req->index = i;
+		}
+	}
+
+	req->state = NWK_FRAG_REQ_STATE_SEND;
+	(void)timer;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static void nwkFragSendAck(uint16_t dst, uint8_t seq, uint8_t status,
+		bool secured)
+{
+	NwkFrame_t *frame;
+	NwkCommandFragmentAck_t *command;
+
+	if (NULL == (frame = nwkFrameAlloc(NWK_FRAME_CLASS_COMMAND,
+			sizeof(NwkCommandFragmentAck_t)))) {
+		return;
+	}
+
+	nwkFrameCommandInit(frame);
+
+	frame->size += sizeof(NwkCommandFragmentAck_t);
+	frame->tx.confirm = NULL;
+
+	frame->header.nwkFcf.security = secured ? 1 : 0;
+	frame->header.nwkDstAddr = dst;
+
+	command = (NwkCommandFragmentAck_t *)frame->payload;
+	command->id = NWK_COMMAND_FRAGMENT_ACK;
+	command->seq = seq;
+	command->status = status;
+
+	if (NWK_SUCCESS_STATUS == status) {
+		memcpy(command->bitmap, nwkFragRx.received, NWK_FRAG_BITMAP_SIZE);
+	} else {
+		memset(command->bitmap, 0, NWK_FRAG_BITMAP_SIZE);
+	}
+
+	nwkTxFrame(frame);
+}
+
+/*************************************************************************//**
+*  @brief Places the received fragment into the reassembly buffer
+*  @param[in] ind Pointer to the indication parameters of the fragment
+*  @return @c true if the fragment was accepted, @c false otherwise
+*
+*  Only one transfer is reassembled at a time. Fragments of other transfers
+*  are ignored until the current one is complete or no fragments were
+*  received for NWK_FRAG_RX_TIMEOUT.
+*****************************************************************************/
+bool nwkFragReceived(NWK_DataInd_t *ind)
+{
+	NwkCommandFragment_t *command = (NwkCommandFragment_t *)ind->data;
+	bool secured = (ind->options & NWK_IND_OPT_SECURED) ? true : false;
+	uint8_t amount, size;
+	uint16_t offset;
+
+	if (ind->size < sizeof(NwkCommandFragment_t) ||
+			NWK_BROADCAST_ADDR == ind->dstAddr) {
+		return false;
+	}
+
+	size = ind->size - sizeof(NwkCommandFragment_t);
+	amount = nwkFragAmount(command->size);
+	offset = (uint16_t)command->index * NWK_FRAG_FRAGMENT_SIZE;
+
+	if (NWK_FRAG_RX_STATE_IDLE == nwkFragRx.state ||
+			nwkFragRx.ind.srcAddr != ind->srcAddr ||
+			nwkFragRx.seq != command->seq) {
+		if (NWK_FRAG_RX_STATE_RECEIVE == nwkFragRx.state) {
+			return false;
+		}
+
+		if (NULL == nwkFragRx.handler || command->size > nwkFragRx.size ||
+				0 == command->size || amount > NWK_FRAG_MAX_FRAGMENTS) {
+			nwkFragSendAck(ind->srcAddr, command->seq, NWK_ERROR_STATUS,
+					secured);
+			return true;
+		}
+
+		nwkFragRx.state = NWK_FRAG_RX_STATE_RECEIVE;
+		nwkFragRx.seq = command->seq;
+		memset(nwkFragRx.received, 0, NWK_FRAG_BITMAP_SIZE);
+
+		nwkFragRx.ind.srcAddr = ind->srcAddr;
+		nwkFragRx.ind.srcEndpoint = command->srcEndpoint;
+		nwkFragRx.ind.dstEndpoint = command->dstEndpoint;
+		nwkFragRx.ind.options = ind->options;
+		nwkFragRx.ind.data = nwkFragRx.buffer;
+		nwkFragRx.ind.size = command->size;
+	}
+
+	if (command->size != nwkFragRx.ind.size || command->index >= amount ||
+			size != ((command->size - offset) < NWK_FRAG_FRAGMENT_SIZE ?
+			command->size - offset : NWK_FRAG_FRAGMENT_SIZE)) {
+		return false;
+	}
+
+	if (NWK_FRAG_RX_STATE_RECEIVE == nwkFragRx.state) {
+		memcpy(nwkFragRx.buffer + offset,
+				ind->data + sizeof(NwkCommandFragment_t), size);
+		nwkFragRx.received[command->index / 8] |=
+				(1 << (command->index % 8));
+		nwkFragRx.ind.lqi = ind->lqi;
+		nwkFragRx.ind.rssi = ind->rssi;
+	}
+
+	SYS_TimerStop(&nwkFragRxTimer);
+	SYS_TimerStart(&nwkFragRxTimer);
+
+	if (command->control & NWK_COMMAND_FRAGMENT_ACK_REQUEST) {
+		nwkFragSendAck(ind->srcAddr, command->seq, NWK_SUCCESS_STATUS,
+				secured);
+	}
+
+	if (NWK_FRAG_RX_STATE_RECEIVE == nwkFragRx.state &&
+			amount == nwkFragNextMissing(nwkFragRx.received, 0, amount)) {
+		nwkFragRx.state = NWK_FRAG_RX_STATE_DONE;
+		nwkFragRx.handler(&nwkFragRx.ind);
+	}
+
+	return true;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static void nwkFragRxTimerHandler(SYS_Timer_t *timer)
+{
+	nwkFragRx.state = NWK_FRAG_RX_STATE_IDLE;
+	(void)timer;
+}
+
+/*************************************************************************//**
+*  @brief Fragmentation module task handler
+*****************************************************************************/
+void nwkFragTaskHandler(void)
+{
+	NWK_FragReq_t *req = nwkFragReqQueue;
+	uint8_t amount;
+
+	if (NULL == req) {
+		return;
+	}
+
+	if (NWK_FRAG_REQ_STATE_SEND == req->state) {
+		amount = nwkFragAmount(req->size);
+
+		while (req->frames < NWK_FRAG_WINDOW) {
+			uint8_t index = nwkFragNextMissing(req->acked, req->index,
+					amount);
+			bool last;
+
+			if (index == amount) {
+				req->index = amount;
+				break;
+			}
+
+			last = (amount == nwkFragNextMissing(req->acked, index + 1,
+					amount));
+
+			if (!nwkFragSendFragment(req, index, last)) {
+				break;
+			}
+
+			req->index = index + 1;
+		}
+	} else if (NWK_FRAG_REQ_STATE_CONFIRM == req->state &&
+			0 == req->frames) {
+		SYS_TimerStop(&nwkFragAckTimer);
+		nwkFragReqQueue = req->next;
+		nwkIb.lock--;
+		req->confirm(req);
+	}
+}
+
+#endif /* NWK_ENABLE_FRAGMENTATION */
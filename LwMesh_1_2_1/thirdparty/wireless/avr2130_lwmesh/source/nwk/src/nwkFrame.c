@@ -40,6 +40,7 @@
 
 /*- Includes ---------------------------------------------------------------*/
 #include <stdlib.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
@@ -47,13 +48,23 @@
 #include "nwk.h"
 #include "nwkFrame.h"
 
-/*- Types ------------------------------------------------------------------*/
-enum {
-	NWK_FRAME_STATE_FREE = 0x00,
-};
+/*- Definitions ------------------------------------------------------------*/
+#define NWK_FRAME_SMALL_SIZE   (offsetof(NwkFrame_t, data) + \
+	sizeof(NwkFrameHeader_t) + NWK_FRAME_SMALL_PAYLOAD_SIZE)
+
+/*- Prototypes -------------------------------------------------------------*/
+static void nwkFrameLink(NwkFrame_t *frame);
+static void nwkFrameUnlink(NwkFrame_t *frame);
 
 /*- Variables --------------------------------------------------------------*/
 static NwkFrame_t nwkFrameFrames[NWK_BUFFERS_AMOUNT];
+#if NWK_SMALL_BUFFERS_AMOUNT > 0
+static uint8_t nwkFrameSmallFrames[NWK_SMALL_BUFFERS_AMOUNT][
+	NWK_FRAME_SMALL_SIZE];
+#endif
+static NwkFrame_t *nwkFrameQueues[NWK_FRAME_STATES_AMOUNT];
+static uint8_t nwkFrameFreeAmount;
+static uint16_t nwkFrameRefused[NWK_FRAME_CLASSES_AMOUNT];
 
 /*- Implementations --------------------------------------------------------*/
 
@@ -62,28 +73,88 @@ static NwkFrame_t nwkFrameFrames[NWK_BUFFERS_AMOUNT];
 *****************************************************************************/
 void nwkFrameInit(void)
 {
+	for (uint8_t i = 0; i < NWK_FRAME_STATES_AMOUNT; i++) {
+		nwkFrameQueues[i] = NULL;
+	}
+
+	for (uint8_t i = 0; i < NWK_FRAME_CLASSES_AMOUNT; i++) {
+		nwkFrameRefused[i] = 0;
+	}
+
+	nwkFrameFreeAmount = NWK_BUFFERS_AMOUNT;
+
 	for (uint8_t i = 0; i < NWK_BUFFERS_AMOUNT; i++) {
 		nwkFrameFrames[i].state = NWK_FRAME_STATE_FREE;
+		nwkFrameLink(&nwkFrameFrames[i]);
+	}
+
+#if NWK_SMALL_BUFFERS_AMOUNT > 0
+	for (uint8_t i = 0; i < NWK_SMALL_BUFFERS_AMOUNT; i++) {
+		NwkFrame_t *frame = (NwkFrame_t *)nwkFrameSmallFrames[i];
+
+		frame->state = NWK_FRAME_STATE_FREE_SMALL;
+		nwkFrameLink(frame);
 	}
+#endif
 }
 
 /*************************************************************************//**
 *  @brief Allocates an empty frame from the buffer pool
+*  @param[in] frameClass Class of the frame (NWK_FRAME_CLASS_*)
+*  @param[in] size Maximum size of the payload that will be placed into the
+*  frame
 *  @return Pointer to the frame or @c NULL if there are no free frames
+*
+*  Small frames are used when the payload and the MIC fit into them, the
+*  regular frames are used otherwise or when there are no free small frames.
+*  The last regular frames are reserved for command and received frames, so
+*  data frames can not take them.
 *****************************************************************************/
-NwkFrame_t *nwkFrameAlloc(void)
+NwkFrame_t *nwkFrameAlloc(uint8_t frameClass, uint8_t size)
 {
-	for (uint8_t i = 0; i < NWK_BUFFERS_AMOUNT; i++) {
-		if (NWK_FRAME_STATE_FREE == nwkFrameFrames[i].state) {
-			memset(&nwkFrameFrames[i], 0, sizeof(NwkFrame_t));
-			nwkFrameFrames[i].size = sizeof(NwkFrameHeader_t);
-			nwkFrameFrames[i].payload = nwkFrameFrames[i].data +
-					sizeof(NwkFrameHeader_t);
-			nwkIb.lock++;
-			return &nwkFrameFrames[i];
+	NwkFrame_t *frame = NULL;
+	uint8_t frameSize = sizeof(NwkFrame_t);
+	uint8_t reserved = 0;
+
+#if NWK_SMALL_BUFFERS_AMOUNT > 0
+	if ((size + NWK_SECURITY_MIC_SIZE) <= NWK_FRAME_SMALL_PAYLOAD_SIZE) {
+		frame = nwkFrameQueues[NWK_FRAME_STATE_FREE_SMALL];
+		frameSize = NWK_FRAME_SMALL_SIZE;
+	}
+#else
+	(void)size;
+#endif
+
+	if (NWK_FRAME_CLASS_DATA == frameClass) {
+		reserved = NWK_COMMAND_BUFFERS_RESERVED + NWK_RX_BUFFERS_RESERVED;
+	} else if (NWK_FRAME_CLASS_RX == frameClass) {
+		reserved = NWK_COMMAND_BUFFERS_RESERVED;
+	}
+
+	if (NULL == frame && nwkFrameFreeAmount > reserved) {
+		frame = nwkFrameQueues[NWK_FRAME_STATE_FREE];
+		frameSize = sizeof(NwkFrame_t);
+		nwkFrameFreeAmount--;
+	}
+
+	if (NULL == frame) {
+		if (nwkFrameRefused[frameClass] < UINT16_MAX) {
+			nwkFrameRefused[frameClass]++;
 		}
+
+		return NULL;
 	}
-	return NULL;
+
+	nwkFrameUnlink(frame);
+
+	memset(frame, 0, frameSize);
+	frame->state = NWK_FRAME_STATE_ALLOCATED;
+	frame->size = sizeof(NwkFrameHeader_t);
+	frame->payload = frame->data + sizeof(NwkFrameHeader_t);
+	nwkFrameLink(frame);
+
+	nwkIb.lock++;
+	return frame;
 }
 
 /*************************************************************************//**
@@ -92,31 +163,157 @@ NwkFrame_t *nwkFrameAlloc(void)
 *****************************************************************************/
 void nwkFrameFree(NwkFrame_t *frame)
 {
-	frame->state = NWK_FRAME_STATE_FREE;
+#if NWK_SMALL_BUFFERS_AMOUNT > 0
+	if ((uint8_t *)frame >= (uint8_t *)nwkFrameSmallFrames &&
+			(uint8_t *)frame <
+			(uint8_t *)&nwkFrameSmallFrames[NWK_SMALL_BUFFERS_AMOUNT]) {
+		nwkFrameSetState(frame, NWK_FRAME_STATE_FREE_SMALL);
+	} else
+#endif
+	{
+		nwkFrameSetState(frame, NWK_FRAME_STATE_FREE);
+		nwkFrameFreeAmount++;
+	}
+
 	nwkIb.lock--;
 }
 
 /*************************************************************************//**
-*  @brief Cycles through the allocated frames starting from the specified @a
-* frame
-*  @param[in] frame Pointer to the current frame or @c NULL for the first frame
-*  @return Next allocated frame or @c NULL if there are no more frames
+*  @brief Returns the number of regular frames the frame class can allocate
+*  @param[in] frameClass Class of the frame (NWK_FRAME_CLASS_*)
+*  @return Number of free regular frames minus the frames reserved for other
+*  classes, small frames are not counted
+*****************************************************************************/
+uint8_t nwkFrameAvailable(uint8_t frameClass)
+{
+	uint8_t reserved = 0;
+
+	if (NWK_FRAME_CLASS_DATA == frameClass) {
+		reserved = NWK_COMMAND_BUFFERS_RESERVED + NWK_RX_BUFFERS_RESERVED;
+	} else if (NWK_FRAME_CLASS_RX == frameClass) {
+		reserved = NWK_COMMAND_BUFFERS_RESERVED;
+	}
+
+	return nwkFrameFreeAmount > reserved ? nwkFrameFreeAmount - reserved : 0;
+}
+
+/*************************************************************************//**
+*  @brief Returns the number of times frame allocation was refused
+*  @param[in] frameClass Class of the frame (NWK_FRAME_CLASS_*)
+*  @return Number of refused allocations, saturated at @c UINT16_MAX
+*****************************************************************************/
+uint16_t NWK_FrameRefusedCount(uint8_t frameClass)
+{
+	return nwkFrameRefused[frameClass];
+}
+
+/*************************************************************************//**
+*  @brief Moves a @a frame to the end of the queue of the new @a state
+*  @param[in] frame Pointer to the frame
+*  @param[in] state New state of the frame
+*****************************************************************************/
+void nwkFrameSetState(NwkFrame_t *frame, uint8_t state)
+{
+	if (state == frame->state) {
+		return;
+	}
+
+	nwkFrameUnlink(frame);
+	frame->state = state;
+	nwkFrameLink(frame);
+}
+
+/*************************************************************************//**
+*  @brief Moves a @a frame to the queue of the new @a state in front of
+*  the @a next frame
+*  @param[in] frame Pointer to the frame
+*  @param[in] state New state of the frame
+*  @param[in] next Frame from the new state queue or @c NULL to append the
+*  frame to the end of the queue
+*****************************************************************************/
+void nwkFrameInsert(NwkFrame_t *frame, uint8_t state, NwkFrame_t *next)
+{
+	nwkFrameUnlink(frame);
+	frame->state = state;
+
+	if (NULL == next) {
+		nwkFrameLink(frame);
+		return;
+	}
+
+	frame->next = next;
+	frame->prev = next->prev;
+	next->prev->next = frame;
+	next->prev = frame;
+
+	if (nwkFrameQueues[state] == next) {
+		nwkFrameQueues[state] = frame;
+	}
+}
+
+/*************************************************************************//**
+*  @brief Returns the oldest frame in the specified @a state
+*  @param[in] state Frame state
+*  @return First frame in the state queue or @c NULL if the queue is empty
+*****************************************************************************/
+NwkFrame_t *nwkFrameFirst(uint8_t state)
+{
+	return nwkFrameQueues[state];
+}
+
+/*************************************************************************//**
+*  @brief Returns the frame following @a frame in the queue of its state
+*  @param[in] frame Pointer to the current frame
+*  @return Next frame in the same state or @c NULL if there are no more frames
+*
+*  Frame state handlers may move the current frame to a different queue, so
+*  the next frame must be obtained before the current one is processed.
 *****************************************************************************/
 NwkFrame_t *nwkFrameNext(NwkFrame_t *frame)
 {
-	if (NULL == frame) {
-		frame = nwkFrameFrames;
+	if (frame->next == nwkFrameQueues[frame->state]) {
+		return NULL;
+	}
+
+	return frame->next;
+}
+
+/*************************************************************************//**
+*  @brief Appends a @a frame to the queue of its current state
+*  @param[in] frame Pointer to the frame
+*****************************************************************************/
+static void nwkFrameLink(NwkFrame_t *frame)
+{
+	NwkFrame_t *head = nwkFrameQueues[frame->state];
+
+	if (NULL == head) {
+		frame->next = frame;
+		frame->prev = frame;
+		nwkFrameQueues[frame->state] = frame;
 	} else {
-		frame++;
+		frame->next = head;
+		frame->prev = head->prev;
+		head->prev->next = frame;
+		head->prev = frame;
 	}
+}
 
-	for (; frame < &nwkFrameFrames[NWK_BUFFERS_AMOUNT]; frame++) {
-		if (NWK_FRAME_STATE_FREE != frame->state) {
-			return frame;
+/*************************************************************************//**
+*  @brief Removes a @a frame from the queue of its current state
+*  @param[in] frame Pointer to the frame
+*****************************************************************************/
+static void nwkFrameUnlink(NwkFrame_t *frame)
+{
+	if (frame->next == frame) {
+		nwkFrameQueues[frame->state] = NULL;
+	} else {
+		frame->prev->next = frame->next;
+		frame->next->prev = frame->prev;
+
+		if (nwkFrameQueues[frame->state] == frame) {
+			nwkFrameQueues[frame->state] = frame->next;
 		}
 	}
-
-	return NULL;
 }
 
 /*************************************************************************//**
@@ -126,6 +323,7 @@ NwkFrame_t *nwkFrameNext(NwkFrame_t *frame)
 void nwkFrameCommandInit(NwkFrame_t *frame)
 {
 	frame->tx.status = NWK_SUCCESS_STATUS;
+	frame->tx.priority = NWK_PRIORITY_HIGH;
 	frame->header.nwkSeq = ++nwkIb.nwkSeqNum;
 	frame->header.nwkSrcAddr = nwkIb.addr;
 #ifdef NWK_ENABLE_SECURE_COMMANDS
@@ -0,0 +1,415 @@
+/**
+ * \file nwkNeighbour.c
+ *
+ * \brief Neighbour table implementation
+ *
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ *
+ */
+
+/*
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/*- Includes ---------------------------------------------------------------*/
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "sysTimer.h"
+#include "sysConfig.h"
+#include "nwk.h"
+#include "nwkTx.h"
+#include "nwkFrame.h"
+#include "nwkNeighbour.h"
+
+#ifdef NWK_ENABLE_NEIGHBOUR_TABLE
+
+/*- Definitions ------------------------------------------------------------*/
+#define NWK_NEIGHBOUR_UNUSED         NWK_BROADCAST_ADDR
+#define NWK_NEIGHBOUR_INDEX_SIZE     (NWK_NEIGHBOUR_TABLE_SIZE * 2)
+#define NWK_NEIGHBOUR_INDEX_NONE     0xff
+#define NWK_NEIGHBOUR_LINK_WEIGHT    4 /* New LQI and RSSI samples weigh 1/4 */
+#define NWK_NEIGHBOUR_RTT_WEIGHT     8 /* New RTT samples weigh 1/8 */
+
+/*- Prototypes -------------------------------------------------------------*/
+static NWK_NeighbourEntry_t *nwkNeighbourNewEntry(uint16_t addr);
+static void nwkNeighbourIndexRemove(uint8_t i);
+
+/*- Variables --------------------------------------------------------------*/
+static NWK_NeighbourEntry_t nwkNeighbourTable[NWK_NEIGHBOUR_TABLE_SIZE];
+
+/* Open addressing hash index over the addresses of the used entries */
+static uint8_t nwkNeighbourIndex[NWK_NEIGHBOUR_INDEX_SIZE];
+
+/* The entry allocated last. The search for a victim starts right after it,
+ * so that entries heard within the same timer tick are replaced in the
+ * order they were allocated. */
+static uint8_t nwkNeighbourLast;
+
+/*- Implementations --------------------------------------------------------*/
+
+/*************************************************************************//**
+*****************************************************************************/
+static inline uint16_t nwkNeighbourHash(uint16_t addr)
+{
+	return (uint16_t)(addr ^ (addr >> 8)) % NWK_NEIGHBOUR_INDEX_SIZE;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static inline uint16_t nwkNeighbourIndexNext(uint16_t slot)
+{
+	return (slot + 1 == NWK_NEIGHBOUR_INDEX_SIZE) ? 0 : slot + 1;
+}
+
+/*************************************************************************//**
+*  @brief Initializes the Neighbour module
+*****************************************************************************/
+void nwkNeighbourInit(void)
+{
+	for (uint16_t i = 0; i < NWK_NEIGHBOUR_INDEX_SIZE; i++) {
+		nwkNeighbourIndex[i] = NWK_NEIGHBOUR_INDEX_NONE;
+	}
+
+	for (uint8_t i = 0; i < NWK_NEIGHBOUR_TABLE_SIZE; i++) {
+		nwkNeighbourTable[i].addr = NWK_NEIGHBOUR_UNUSED;
+	}
+
+	nwkNeighbourLast = NWK_NEIGHBOUR_TABLE_SIZE - 1;
+}
+
+/*************************************************************************//**
+*  @brief Finds the neighbour table entry for the node @a addr
+*  @param[in] addr Short address of the neighbour
+*  @return Pointer to the entry or NULL if the node is not a known neighbour
+*****************************************************************************/
+NWK_NeighbourEntry_t *NWK_NeighbourFind(uint16_t addr)
+{
+	uint16_t slot;
+
+	for (slot = nwkNeighbourHash(addr);
+			NWK_NEIGHBOUR_INDEX_NONE != nwkNeighbourIndex[slot];
+			slot = nwkNeighbourIndexNext(slot)) {
+		NWK_NeighbourEntry_t *entry =
+				&nwkNeighbourTable[nwkNeighbourIndex[slot]];
+
+		if (addr == entry->addr) {
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+/*************************************************************************//**
+*  @brief Starts the iteration over the known neighbours
+*  @return Pointer to the first used entry or NULL if the table is empty
+*****************************************************************************/
+NWK_NeighbourEntry_t *NWK_NeighbourFirst(void)
+{
+	return NWK_NeighbourNext(NULL);
+}
+
+/*************************************************************************//**
+*  @brief Continues the iteration over the known neighbours
+*  @param[in] entry Pointer to the current entry
+*  @return Pointer to the next used entry or NULL if there are no more
+*****************************************************************************/
+NWK_NeighbourEntry_t *NWK_NeighbourNext(NWK_NeighbourEntry_t *entry)
+{
+	uint8_t i = entry ? (entry - nwkNeighbourTable) + 1 : 0;
+
+	for (; i < NWK_NEIGHBOUR_TABLE_SIZE; i++) {
+		if (NWK_NEIGHBOUR_UNUSED != nwkNeighbourTable[i].addr) {
+			return &nwkNeighbourTable[i];
+		}
+	}
+
+	return NULL;
+}
+
+/*************************************************************************//**
+*  @brief Forgets everything known about the neighbour @a entry. It is safe
+*  to remove the current entry while iterating over the table.
+*  @param[in] entry Pointer to the entry
+*****************************************************************************/
+void NWK_NeighbourRemove(NWK_NeighbourEntry_t *entry)
+{
+	nwkNeighbourIndexRemove(entry - nwkNeighbourTable);
+	entry->addr = NWK_NEIGHBOUR_UNUSED;
+}
+
+/*************************************************************************//**
+*  @brief Returns the expected number of transmissions needed to deliver a
+*  frame to the neighbour @a addr. The delivery ratio observed on
+*  transmission dominates, the smoothed LQI of received frames is used on its
+*  own until there were transmissions to the neighbour.
+*  @param[in] addr Short address of the neighbour
+*  @return ETX in units of 1/NWK_NEIGHBOUR_ETX_UNIT transmissions, or
+*  NWK_NEIGHBOUR_ETX_MAX if nothing is known about the link
+*****************************************************************************/
+uint16_t NWK_NeighbourEtx(uint16_t addr)
+{
+	NWK_NeighbourEntry_t *entry = NWK_NeighbourFind(addr);
+	uint16_t lqiEtx;
+
+	if (NULL == entry) {
+		return NWK_NEIGHBOUR_ETX_MAX;
+	}
+
+	if (0 == entry->lqi) {
+		return entry->txEtx ? entry->txEtx : NWK_NEIGHBOUR_ETX_MAX;
+	}
+
+	lqiEtx = (uint16_t)NWK_NEIGHBOUR_ETX_UNIT * 255 / entry->lqi;
+
+	if (lqiEtx > NWK_NEIGHBOUR_ETX_MAX) {
+		lqiEtx = NWK_NEIGHBOUR_ETX_MAX;
+	}
+
+	if (entry->txEtx) {
+		return (entry->txEtx * 3 + lqiEtx) / 4;
+	}
+
+	return lqiEtx;
+}
+
+/*************************************************************************//**
+*  @brief Updates the link statistics of the neighbour that sent the @a frame
+*  @param[in] frame Pointer to the received frame
+*****************************************************************************/
+void nwkNeighbourFrameReceived(NwkFrame_t *frame)
+{
+	uint16_t addr = frame->header.macSrcAddr;
+	NWK_NeighbourEntry_t *entry = NWK_NeighbourFind(addr);
+	uint8_t lqi = NWK_LinearizeLqi(frame->rx.lqi);
+
+	if (NULL == entry) {
+		entry = nwkNeighbourNewEntry(addr);
+	}
+
+	if (0 == entry->lqi) {
+		entry->lqi = lqi;
+		entry->rssi = frame->rx.rssi;
+	} else {
+		entry->lqi = ((uint16_t)entry->lqi *
+				(NWK_NEIGHBOUR_LINK_WEIGHT - 1) + lqi) /
+				NWK_NEIGHBOUR_LINK_WEIGHT;
+		entry->rssi = ((int16_t)entry->rssi *
+				(NWK_NEIGHBOUR_LINK_WEIGHT - 1) + frame->rx.rssi) /
+				NWK_NEIGHBOUR_LINK_WEIGHT;
+	}
+
+	entry->lastHeard = SYS_TimerTime();
+}
+
+/*************************************************************************//**
+*  @brief Accounts a transmission attempt of the @a frame to its next hop.
+*  Every NWK_NEIGHBOUR_ETX_WINDOW attempts the observed delivery ratio is
+*  folded into the ETX of the link.
+*  @param[in] frame Pointer to the transmitted frame
+*****************************************************************************/
+void nwkNeighbourFrameSent(NwkFrame_t *frame)
+{
+	uint16_t addr = frame->header.macDstAddr;
+	uint8_t status = frame->tx.status;
+	NWK_NeighbourEntry_t *entry;
+	uint16_t sample;
+
+	if (NWK_BROADCAST_ADDR == addr) {
+		return;
+	}
+
+	/* A missing end-to-end acknowledgement still means that the frame
+	 * was acknowledged by the neighbour */
+	if (NWK_SUCCESS_STATUS != status && NWK_NO_ACK_STATUS != status &&
+			NWK_PHY_NO_ACK_STATUS != status) {
+		return;
+	}
+
+	if (NULL == (entry = NWK_NeighbourFind(addr))) {
+		entry = nwkNeighbourNewEntry(addr);
+	}
+
+	/* Keep the ratio when the counters saturate */
+	if (0xffff == entry->txAttempts) {
+		entry->txAttempts >>= 1;
+		entry->txSuccesses >>= 1;
+	}
+
+	entry->txAttempts++;
+	entry->windowAttempts++;
+
+	if (NWK_PHY_NO_ACK_STATUS != status) {
+		entry->txSuccesses++;
+		entry->windowSuccesses++;
+	}
+
+	if (entry->windowAttempts < NWK_NEIGHBOUR_ETX_WINDOW) {
+		return;
+	}
+
+	if (entry->windowSuccesses) {
+		sample = (uint16_t)NWK_NEIGHBOUR_ETX_UNIT *
+				entry->windowAttempts / entry->windowSuccesses;
+	} else {
+		sample = NWK_NEIGHBOUR_ETX_MAX;
+	}
+
+	if (entry->txEtx) {
+		entry->txEtx = (entry->txEtx + sample) / 2;
+	} else {
+		entry->txEtx = sample;
+	}
+
+	entry->windowAttempts = 0;
+	entry->windowSuccesses = 0;
+}
+
+/*************************************************************************//**
+*  @brief Updates the ACK round trip time of the neighbour @a addr
+*  @param[in] addr Short address of the neighbour
+*  @param[in] rtt  Round trip time sample in ms
+*****************************************************************************/
+void nwkNeighbourAckReceived(uint16_t addr, uint16_t rtt)
+{
+	NWK_NeighbourEntry_t *entry = NWK_NeighbourFind(addr);
+
+	if (NULL == entry) {
+		return;
+	}
+
+	if (0 == entry->rtt) {
+		entry->rtt = rtt ? rtt : 1;
+	} else {
+		entry->rtt = ((uint32_t)entry->rtt * (NWK_NEIGHBOUR_RTT_WEIGHT - 1) +
+				rtt) / NWK_NEIGHBOUR_RTT_WEIGHT;
+	}
+}
+
+/*************************************************************************//**
+*  @brief Allocates an entry for the neighbour @a addr, replacing the one
+*  that was not heard from for the longest time if the table is full
+*****************************************************************************/
+static NWK_NeighbourEntry_t *nwkNeighbourNewEntry(uint16_t addr)
+{
+	NWK_NeighbourEntry_t *entry = NULL;
+	uint32_t now = SYS_TimerTime();
+	uint8_t i = nwkNeighbourLast;
+	uint16_t slot;
+
+	for (uint8_t n = 0; n < NWK_NEIGHBOUR_TABLE_SIZE; n++) {
+		NWK_NeighbourEntry_t *iter;
+
+		i = (i + 1 == NWK_NEIGHBOUR_TABLE_SIZE) ? 0 : i + 1;
+		iter = &nwkNeighbourTable[i];
+
+		if (NWK_NEIGHBOUR_UNUSED == iter->addr) {
+			entry = iter;
+			break;
+		}
+
+		if (NULL == entry ||
+				now - iter->lastHeard > now - entry->lastHeard) {
+			entry = iter;
+		}
+	}
+
+	if (NWK_NEIGHBOUR_UNUSED != entry->addr) {
+		NWK_NeighbourRemove(entry);
+	}
+
+	nwkNeighbourLast = entry - nwkNeighbourTable;
+
+	entry->lastHeard = now;
+	entry->addr = addr;
+	entry->txAttempts = 0;
+	entry->txSuccesses = 0;
+	entry->txEtx = 0;
+	entry->rtt = 0;
+	entry->lqi = 0;
+	entry->rssi = 0;
+	entry->windowAttempts = 0;
+	entry->windowSuccesses = 0;
+
+	slot = nwkNeighbourHash(addr);
+
+	while (NWK_NEIGHBOUR_INDEX_NONE != nwkNeighbourIndex[slot]) {
+		slot = nwkNeighbourIndexNext(slot);
+	}
+
+	nwkNeighbourIndex[slot] = entry - nwkNeighbourTable;
+
+	return entry;
+}
+
+/*************************************************************************//**
+*  @brief Removes the entry @a i from the index. The following entries of
+*  the probe sequence are shifted back, so no deleted markers are needed.
+*****************************************************************************/
+static void nwkNeighbourIndexRemove(uint8_t i)
+{
+	uint16_t slot = nwkNeighbourHash(nwkNeighbourTable[i].addr);
+	uint16_t next, home;
+
+	while (i != nwkNeighbourIndex[slot]) {
+		if (NWK_NEIGHBOUR_INDEX_NONE == nwkNeighbourIndex[slot]) {
+			return;
+		}
+
+		slot = nwkNeighbourIndexNext(slot);
+	}
+
+	next = slot;
+
+	while (1) {
+		nwkNeighbourIndex[slot] = NWK_NEIGHBOUR_INDEX_NONE;
+
+		do {
+			next = nwkNeighbourIndexNext(next);
+
+			if (NWK_NEIGHBOUR_INDEX_NONE == nwkNeighbourIndex[next]) {
+				return;
+			}
+
+			home = nwkNeighbourHash(
+					nwkNeighbourTable[nwkNeighbourIndex[next]].addr);
+
+			/* Keep the entry in place if its home slot lies cyclically
+			 * in (slot, next] */
+		} while (slot <= next ? (slot < home && home <= next) :
+				(slot < home || home <= next));
+
+		nwkNeighbourIndex[slot] = nwkNeighbourIndex[next];
+		slot = next;
+	}
+}
+
+#endif /* NWK_ENABLE_NEIGHBOUR_TABLE */
@@ -43,6 +43,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "sysConfig.h"
+#include "sysTimer.h"
 #include "nwk.h"
 #include "nwkTx.h"
 #include "nwkFrame.h"
@@ -50,43 +51,165 @@
 #include "nwkGroup.h"
 #include "nwkCommand.h"
 #include "nwkRouteDiscovery.h"
+#include "nwkNeighbour.h"
 
 #ifdef NWK_ENABLE_ROUTING
 
 /*- Definitions ------------------------------------------------------------*/
 #define NWK_ROUTE_MAX_RANK         255
+#define NWK_ROUTE_MAX_LQI          255
 #define NWK_ROUTE_DEFAULT_RANK     128
 
+/* The index is kept at most half full, so that probe sequences stay short */
+#define NWK_ROUTE_INDEX_SIZE       (NWK_ROUTE_TABLE_SIZE * 2)
+#define NWK_ROUTE_INDEX_NONE       ((NwkRouteIndex_t)-1)
+
+/*- Types ------------------------------------------------------------------*/
+#if NWK_ROUTE_TABLE_SIZE < 255
+typedef uint8_t NwkRouteIndex_t;
+#else
+typedef uint16_t NwkRouteIndex_t;
+#endif
+
+typedef struct NwkRouteLruNode_t {
+	NwkRouteIndex_t prev;
+	NwkRouteIndex_t next;
+} NwkRouteLruNode_t;
+
+#ifdef NWK_ENABLE_MULTIPATH
+typedef struct NwkRouteHop_t {
+	uint16_t addr;
+	uint8_t lqi;
+} NwkRouteHop_t;
+
+typedef struct NwkRouteAlternates_t {
+	NwkRouteHop_t hop[NWK_ROUTE_ALTERNATES_AMOUNT];
+  #ifdef NWK_ENABLE_MULTIPATH_BALANCING
+	uint8_t turn;
+  #endif
+} NwkRouteAlternates_t;
+#endif
+
 /*- Prototypes -------------------------------------------------------------*/
 static void nwkRouteSendRouteError(uint16_t src, uint16_t dst,
 		uint8_t multicast);
-static void nwkRouteNormalizeRanks(void);
+static void nwkRouteIndexAdd(NwkRouteIndex_t i);
+static void nwkRouteIndexRemove(NwkRouteIndex_t i);
+static void nwkRouteIndexPending(void);
+static bool nwkRoutePendingClear(NwkRouteIndex_t i);
+static NWK_RouteTableEntry_t *nwkRouteAllocEntry(void);
+static void nwkRouteLruUnlink(NwkRouteIndex_t i);
+static void nwkRouteLruInsert(NwkRouteIndex_t i, bool recent);
+#ifdef NWK_ENABLE_MULTIPATH
+static void nwkRouteAlternatesClear(NwkRouteIndex_t i);
+static void nwkRouteAlternateInsert(NwkRouteIndex_t i, uint16_t addr,
+		uint8_t lqi);
+static void nwkRouteAlternateRemove(NwkRouteIndex_t i, uint16_t addr);
+static bool nwkRouteFailover(NWK_RouteTableEntry_t *entry);
+#endif
+#ifdef NWK_ENABLE_MULTIPATH_BALANCING
+static uint16_t nwkRouteBalancedNextHop(NWK_RouteTableEntry_t *entry);
+#endif
+#ifdef NWK_ENABLE_EXPANDING_RING
+static void nwkRouteConfirm(NwkRouteIndex_t i, bool confirmed);
+#endif
 
 /*- Variables --------------------------------------------------------------*/
 static NWK_RouteTableEntry_t nwkRouteTable[NWK_ROUTE_TABLE_SIZE];
 
+/* Open addressing hash index over (dstAddr, multicast) of the used entries */
+static NwkRouteIndex_t nwkRouteIndex[NWK_ROUTE_INDEX_SIZE];
+
+/* Eviction list of all entries, least recently used entries and free
+ * entries first */
+static NwkRouteLruNode_t nwkRouteLru[NWK_ROUTE_TABLE_SIZE];
+static NwkRouteIndex_t nwkRouteLruHead;
+static NwkRouteIndex_t nwkRouteLruTail;
+
+/* Entries handed out by NWK_RouteNewEntry() that are added to the index
+ * once their destination is set */
+static uint8_t nwkRoutePending[(NWK_ROUTE_TABLE_SIZE + 7) / 8];
+static NwkRouteIndex_t nwkRoutePendingAmount;
+
+#ifdef NWK_ENABLE_MULTIPATH
+/* Alternate next hops of each route, best first. Unused slots are at the
+ * end and have the address NWK_ROUTE_UNKNOWN. */
+static NwkRouteAlternates_t nwkRouteAlternates[NWK_ROUTE_TABLE_SIZE];
+#endif
+
+#ifdef NWK_ENABLE_EXPANDING_RING
+/* Time each route was last found by route discovery or delivered a frame */
+static uint32_t nwkRouteConfirmed[NWK_ROUTE_TABLE_SIZE];
+#endif
+
 /*- Implementations --------------------------------------------------------*/
 
+/*************************************************************************//**
+*****************************************************************************/
+static inline uint16_t nwkRouteHash(uint16_t dst, uint8_t multicast)
+{
+	/* Sequential addresses must not land in adjacent slots. A long run of
+	 * used slots makes every removal walk the run to its end. */
+	return (uint16_t)((dst ^ (multicast ? 0x5555 : 0)) * 40503u) %
+	       NWK_ROUTE_INDEX_SIZE;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static inline uint16_t nwkRouteIndexNext(uint16_t slot)
+{
+	return (slot + 1 == NWK_ROUTE_INDEX_SIZE) ? 0 : slot + 1;
+}
+
 /*************************************************************************//**
 *  @brief Initializes the Routing module
 *****************************************************************************/
 void nwkRouteInit(void)
 {
-	for (uint8_t i = 0; i < NWK_ROUTE_TABLE_SIZE; i++) {
+	nwkRouteLruHead = NWK_ROUTE_INDEX_NONE;
+	nwkRouteLruTail = NWK_ROUTE_INDEX_NONE;
+	nwkRoutePendingAmount = 0;
+
+	for (uint16_t i = 0; i < sizeof(nwkRoutePending); i++) {
+		nwkRoutePending[i] = 0;
+	}
+
+	for (uint16_t i = 0; i < NWK_ROUTE_INDEX_SIZE; i++) {
+		nwkRouteIndex[i] = NWK_ROUTE_INDEX_NONE;
+	}
+
+	for (uint16_t i = 0; i < NWK_ROUTE_TABLE_SIZE; i++) {
 		nwkRouteTable[i].dstAddr = NWK_ROUTE_UNKNOWN;
 		nwkRouteTable[i].fixed = 0;
 		nwkRouteTable[i].rank = 0;
+		nwkRouteLruInsert(i, true);
+#ifdef NWK_ENABLE_MULTIPATH
+		nwkRouteAlternatesClear(i);
+#endif
 	}
 }
 
 /*************************************************************************//**
+*  @brief Finds the route table entry for the destination @a dst
+*  @param[in] dst       Destination address
+*  @param[in] multicast Non-zero for a multicast group address
+*  @return Pointer to the entry or NULL if there is no route
 *****************************************************************************/
 NWK_RouteTableEntry_t *NWK_RouteFindEntry(uint16_t dst, uint8_t multicast)
 {
-	for (uint8_t i = 0; i < NWK_ROUTE_TABLE_SIZE; i++) {
-		if (nwkRouteTable[i].dstAddr == dst &&
-				nwkRouteTable[i].multicast == multicast) {
-			return &nwkRouteTable[i];
+	uint16_t slot;
+
+	if (nwkRoutePendingAmount) {
+		nwkRouteIndexPending();
+	}
+
+	for (slot = nwkRouteHash(dst, multicast);
+			NWK_ROUTE_INDEX_NONE != nwkRouteIndex[slot];
+			slot = nwkRouteIndexNext(slot)) {
+		NWK_RouteTableEntry_t *entry = &nwkRouteTable[nwkRouteIndex[slot]];
+
+		if (entry->dstAddr == dst && entry->multicast == multicast) {
+			return entry;
 		}
 	}
 
@@ -94,31 +217,103 @@ NWK_RouteTableEntry_t *NWK_RouteFindEntry(uint16_t dst, uint8_t multicast)
 }
 
 /*************************************************************************//**
+*  @brief Allocates a route table entry, replacing the least recently used
+*  route if there are no free entries. The application sets the destination
+*  address and the multicast flag of the entry before the next call to the
+*  routing functions. They must not be changed later.
+*  @return Pointer to the entry or NULL if all entries are fixed
 *****************************************************************************/
 NWK_RouteTableEntry_t *NWK_RouteNewEntry(void)
 {
-	NWK_RouteTableEntry_t *iter = nwkRouteTable;
-	NWK_RouteTableEntry_t *entry = NULL;
+	NWK_RouteTableEntry_t *entry;
+	NwkRouteIndex_t i;
 
-	for (uint8_t i = 0; i < NWK_ROUTE_TABLE_SIZE; i++, iter++) {
-		if (iter->fixed) {
-			continue;
-		}
+	if (nwkRoutePendingAmount) {
+		nwkRouteIndexPending();
+	}
 
-		if (0 == iter->rank) {
-			entry = iter;
-			break;
-		}
+	if (NULL == (entry = nwkRouteAllocEntry())) {
+		return NULL;
+	}
+
+	i = entry - nwkRouteTable;
+	entry->dstAddr = NWK_ROUTE_UNKNOWN;
+	entry->multicast = 0;
+
+	nwkRoutePending[i / 8] |= (uint8_t)(1 << (i % 8));
+	nwkRoutePendingAmount++;
+
+	return entry;
+}
+
+/*************************************************************************//**
+*  @brief Allocates a route table entry for the destination @a dst that has
+*  no entry yet and adds it to the index
+*  @return Pointer to the entry or NULL if all entries are fixed or @a dst
+*  is NWK_ROUTE_UNKNOWN
+*****************************************************************************/
+NWK_RouteTableEntry_t *nwkRouteNewEntry(uint16_t dst, uint8_t multicast)
+{
+	NWK_RouteTableEntry_t *entry;
 
-		if (NULL == entry || iter->rank < entry->rank) {
-			entry = iter;
+	/* An entry with this address is free, it could not be found again */
+	if (NWK_ROUTE_UNKNOWN == dst) {
+		return NULL;
+	}
+
+	if (NULL == (entry = nwkRouteAllocEntry())) {
+		return NULL;
+	}
+
+	entry->dstAddr = dst;
+	entry->multicast = multicast ? 1 : 0;
+	nwkRouteIndexAdd(entry - nwkRouteTable);
+
+	return entry;
+}
+
+/*************************************************************************//**
+*  @brief Takes the least recently used entry that is not fixed out of the
+*  index and makes it the most recently used one
+*****************************************************************************/
+static NWK_RouteTableEntry_t *nwkRouteAllocEntry(void)
+{
+	NWK_RouteTableEntry_t *entry;
+	NwkRouteIndex_t i;
+	uint16_t skipped = 0;
+
+	/* Fixed entries stay on the list, so that they can be replaced again
+	 * once the application releases them. They are moved to the end. */
+	while (nwkRouteTable[nwkRouteLruHead].fixed) {
+		if (++skipped == NWK_ROUTE_TABLE_SIZE) {
+			return NULL;
 		}
+
+		i = nwkRouteLruHead;
+		nwkRouteLruUnlink(i);
+		nwkRouteLruInsert(i, true);
 	}
 
-	entry->multicast = 0;
+	i = nwkRouteLruHead;
+	entry = &nwkRouteTable[i];
+
+	if (!nwkRoutePendingClear(i) && NWK_ROUTE_UNKNOWN != entry->dstAddr) {
+		nwkRouteIndexRemove(i);
+	}
+
+	nwkRouteLruUnlink(i);
+	nwkRouteLruInsert(i, true);
+
 	entry->score = NWK_ROUTE_DEFAULT_SCORE;
 	entry->rank = NWK_ROUTE_DEFAULT_RANK;
 
+#ifdef NWK_ENABLE_MULTIPATH
+	nwkRouteAlternatesClear(i);
+#endif
+#ifdef NWK_ENABLE_EXPANDING_RING
+	nwkRouteConfirm(i, false);
+#endif
+
 	return entry;
 }
 
@@ -126,12 +321,25 @@ NWK_RouteTableEntry_t *NWK_RouteNewEntry(void)
 *****************************************************************************/
 void NWK_RouteFreeEntry(NWK_RouteTableEntry_t *entry)
 {
+	NwkRouteIndex_t i = entry - nwkRouteTable;
+
 	if (entry->fixed) {
 		return;
 	}
 
+	if (!nwkRoutePendingClear(i) && NWK_ROUTE_UNKNOWN != entry->dstAddr) {
+		nwkRouteIndexRemove(i);
+	}
+
+	nwkRouteLruUnlink(i);
+	nwkRouteLruInsert(i, false);
+
 	entry->dstAddr = NWK_ROUTE_UNKNOWN;
 	entry->rank = 0;
+
+#ifdef NWK_ENABLE_MULTIPATH
+	nwkRouteAlternatesClear(i);
+#endif
 }
 
 /*************************************************************************//**
@@ -165,17 +373,74 @@ void nwkRouteUpdateEntry(uint16_t dst, uint8_t multicast, uint16_t nextHop,
 	entry = NWK_RouteFindEntry(dst, multicast);
 
 	if (NULL == entry) {
-		entry = NWK_RouteNewEntry();
+		entry = nwkRouteNewEntry(dst, multicast);
+
+		if (NULL == entry) {
+			return;
+		}
+	} else {
+		if (!entry->fixed) {
+			nwkRouteLruUnlink(entry - nwkRouteTable);
+			nwkRouteLruInsert(entry - nwkRouteTable, true);
+		}
+
+#ifdef NWK_ENABLE_MULTIPATH
+		if (entry->nextHopAddr != nextHop) {
+			nwkRouteAlternateInsert(entry - nwkRouteTable,
+					entry->nextHopAddr, entry->lqi);
+		}
+#endif
 	}
 
-	entry->dstAddr = dst;
+#ifdef NWK_ENABLE_MULTIPATH
+	nwkRouteAlternateRemove(entry - nwkRouteTable, nextHop);
+#endif
+
 	entry->nextHopAddr = nextHop;
-	entry->multicast = multicast;
 	entry->score = NWK_ROUTE_DEFAULT_SCORE;
 	entry->rank = NWK_ROUTE_DEFAULT_RANK;
 	entry->lqi = lqi;
+
+#ifdef NWK_ENABLE_EXPANDING_RING
+	nwkRouteConfirm(entry - nwkRouteTable, true);
+#endif
+}
+
+#ifdef NWK_ENABLE_MULTIPATH
+/*************************************************************************//**
+*  @brief Records @a nextHop as an alternate next hop of an existing route.
+*  Nothing is done if there is no route to @a dst or if it is fixed.
+*****************************************************************************/
+void nwkRouteAddAlternate(uint16_t dst, uint8_t multicast, uint16_t nextHop,
+		uint8_t lqi)
+{
+	NWK_RouteTableEntry_t *entry;
+
+	entry = NWK_RouteFindEntry(dst, multicast);
+
+	if (entry && !entry->fixed) {
+		nwkRouteAlternateInsert(entry - nwkRouteTable, nextHop, lqi);
+	}
+}
+
+#endif
+
+#ifdef NWK_ENABLE_EXPANDING_RING
+/*************************************************************************//**
+*  @brief Checks whether the route @a entry is recent enough to answer route
+*  requests on behalf of its destination. Fixed routes are always fresh,
+*  other routes for NWK_ROUTE_DISCOVERY_FRESH_TIME after they were found or
+*  delivered a frame, unless a transmission failed since.
+*****************************************************************************/
+bool nwkRouteIsFresh(NWK_RouteTableEntry_t *entry)
+{
+	return entry->fixed || SYS_TimerTime() -
+	       nwkRouteConfirmed[entry - nwkRouteTable] <
+	       NWK_ROUTE_DISCOVERY_FRESH_TIME;
 }
 
+#endif
+
 /*************************************************************************//**
 *****************************************************************************/
 void nwkRouteRemove(uint16_t dst, uint8_t multicast)
@@ -211,15 +476,44 @@ void nwkRouteFrameReceived(NwkFrame_t *frame)
 		bool discovery = (NWK_BROADCAST_ADDR == header->macDstAddr &&
 				nwkIb.addr == header->nwkDstAddr);
 
+#ifdef NWK_ENABLE_ETX
+		/* Switch only to a link that is better by a margin, so that the
+		 * route does not flap between next hops of similar quality */
+		if ((entry->nextHopAddr != header->macSrcAddr &&
+				NWK_NeighbourEtx(header->macSrcAddr) +
+				NWK_ROUTE_ETX_HYSTERESIS <
+				NWK_NeighbourEtx(entry->nextHopAddr)) || discovery) {
+#else
 		if ((entry->nextHopAddr != header->macSrcAddr && frame->rx.lqi >
 				entry->lqi) || discovery) {
+#endif
+#ifdef NWK_ENABLE_MULTIPATH
+			if (entry->nextHopAddr != header->macSrcAddr) {
+				nwkRouteAlternateInsert(entry - nwkRouteTable,
+						entry->nextHopAddr, entry->lqi);
+				nwkRouteAlternateRemove(entry - nwkRouteTable,
+						header->macSrcAddr);
+			}
+#endif
 			entry->nextHopAddr = header->macSrcAddr;
 			entry->score = NWK_ROUTE_DEFAULT_SCORE;
 		}
+#ifdef NWK_ENABLE_MULTIPATH
+		else if (entry->nextHopAddr != header->macSrcAddr) {
+			/* The link quality of the entry belongs to the primary
+			 * next hop */
+			nwkRouteAlternateInsert(entry - nwkRouteTable,
+					header->macSrcAddr, frame->rx.lqi);
+			return;
+		}
+#endif
 	} else {
-		entry = NWK_RouteNewEntry();
+		entry = nwkRouteNewEntry(header->nwkSrcAddr, false);
+
+		if (NULL == entry) {
+			return;
+		}
 
-		entry->dstAddr = header->nwkSrcAddr;
 		entry->nextHopAddr = header->macSrcAddr;
 	}
 
@@ -249,10 +543,38 @@ void nwkRouteFrameSent(NwkFrame_t *frame)
 	if (NWK_SUCCESS_STATUS == frame->tx.status) {
 		entry->score = NWK_ROUTE_DEFAULT_SCORE;
 
-		if (NWK_ROUTE_MAX_RANK == ++entry->rank) {
-			nwkRouteNormalizeRanks();
+		if (entry->rank < NWK_ROUTE_MAX_RANK) {
+			entry->rank++;
 		}
+
+		nwkRouteLruUnlink(entry - nwkRouteTable);
+		nwkRouteLruInsert(entry - nwkRouteTable, true);
+
+#ifdef NWK_ENABLE_EXPANDING_RING
+		nwkRouteConfirm(entry - nwkRouteTable, true);
+#endif
 	} else {
+#ifdef NWK_ENABLE_MULTIPATH
+		/* A balanced frame was sent through one of the alternates */
+		if (NWK_PHY_NO_ACK_STATUS == frame->tx.status &&
+				frame->header.macDstAddr != entry->nextHopAddr) {
+			nwkRouteAlternateRemove(entry - nwkRouteTable,
+					frame->header.macDstAddr);
+			return;
+		}
+#endif
+#ifdef NWK_ENABLE_EXPANDING_RING
+		nwkRouteConfirm(entry - nwkRouteTable, false);
+#endif
+#ifdef NWK_ENABLE_MULTIPATH
+		/* The next hop did not acknowledge the frame, so switch to the
+		 * best alternate right away instead of waiting for the score to
+		 * run out */
+		if (NWK_PHY_NO_ACK_STATUS == frame->tx.status &&
+				nwkRouteFailover(entry)) {
+			return;
+		}
+#endif
 		if (0 == --entry->score) {
 			NWK_RouteFreeEntry(entry);
 		}
@@ -280,8 +602,16 @@ void nwkRoutePrepareTx(NwkFrame_t *frame)
 #endif
 
 	else {
+#ifdef NWK_ENABLE_MULTIPATH_BALANCING
+		NWK_RouteTableEntry_t *entry = NWK_RouteFindEntry(
+				header->nwkDstAddr, header->nwkFcf.multicast);
+
+		header->macDstAddr = entry ? nwkRouteBalancedNextHop(entry) :
+				NWK_ROUTE_UNKNOWN;
+#else
 		header->macDstAddr = NWK_RouteNextHop(header->nwkDstAddr,
 				header->nwkFcf.multicast);
+#endif
 
   #ifdef NWK_ENABLE_ROUTE_DISCOVERY
 		if (NWK_ROUTE_UNKNOWN == header->macDstAddr) {
@@ -302,6 +632,7 @@ void nwkRouteFrame(NwkFrame_t *frame)
 			header->nwkFcf.multicast)) {
 		frame->tx.confirm = NULL;
 		frame->tx.control = NWK_TX_CONTROL_ROUTING;
+		frame->tx.priority = NWK_PRIORITY_NORMAL;
 		nwkTxFrame(frame);
 	} else {
 		nwkRouteSendRouteError(header->nwkSrcAddr, header->nwkDstAddr,
@@ -318,7 +649,8 @@ static void nwkRouteSendRouteError(uint16_t src, uint16_t dst,
 	NwkFrame_t *frame;
 	NwkCommandRouteError_t *command;
 
-	if (NULL == (frame = nwkFrameAlloc())) {
+	if (NULL == (frame = nwkFrameAlloc(NWK_FRAME_CLASS_COMMAND,
+			sizeof(NwkCommandRouteError_t)))) {
 		return;
 	}
 
@@ -353,13 +685,347 @@ bool nwkRouteErrorReceived(NWK_DataInd_t *ind)
 	return true;
 }
 
+/*************************************************************************//**
+*  @brief Adds the entry @a i to the index, using its current key
+*****************************************************************************/
+static void nwkRouteIndexAdd(NwkRouteIndex_t i)
+{
+	NWK_RouteTableEntry_t *entry = &nwkRouteTable[i];
+	uint16_t slot = nwkRouteHash(entry->dstAddr, entry->multicast);
+
+	while (NWK_ROUTE_INDEX_NONE != nwkRouteIndex[slot]) {
+		slot = nwkRouteIndexNext(slot);
+	}
+
+	nwkRouteIndex[slot] = i;
+}
+
+/*************************************************************************//**
+*  @brief Removes the entry @a i from the index. The following entries of
+*  the probe sequence are shifted back, so no deleted markers are needed.
+*****************************************************************************/
+static void nwkRouteIndexRemove(NwkRouteIndex_t i)
+{
+	NWK_RouteTableEntry_t *entry = &nwkRouteTable[i];
+	uint16_t slot = nwkRouteHash(entry->dstAddr, entry->multicast);
+	uint16_t next, home;
+
+	while (i != nwkRouteIndex[slot]) {
+		if (NWK_ROUTE_INDEX_NONE == nwkRouteIndex[slot]) {
+			return;
+		}
+
+		slot = nwkRouteIndexNext(slot);
+	}
+
+	next = slot;
+
+	while (1) {
+		nwkRouteIndex[slot] = NWK_ROUTE_INDEX_NONE;
+
+		do {
+			next = nwkRouteIndexNext(next);
+
+			if (NWK_ROUTE_INDEX_NONE == nwkRouteIndex[next]) {
+				return;
+			}
+
+			entry = &nwkRouteTable[nwkRouteIndex[next]];
+			home = nwkRouteHash(entry->dstAddr, entry->multicast);
+
+			/* Keep the entry in place if its home slot lies cyclically
+			 * in (slot, next] */
+		} while (slot <= next ? (slot < home && home <= next) :
+				(slot < home || home <= next));
+
+		nwkRouteIndex[slot] = nwkRouteIndex[next];
+		slot = next;
+	}
+}
+
+/*************************************************************************//**
+*  @brief Adds the entries from NWK_RouteNewEntry() to the index once their
+*  destination is set
+*****************************************************************************/
+static void nwkRouteIndexPending(void)
+{
+	for (uint16_t i = 0; i < NWK_ROUTE_TABLE_SIZE &&
+			nwkRoutePendingAmount; i++) {
+		if (0 == nwkRoutePending[i / 8]) {
+			i |= 7;
+			continue;
+		}
+
+		if (NWK_ROUTE_UNKNOWN != nwkRouteTable[i].dstAddr &&
+				nwkRoutePendingClear(i)) {
+			nwkRouteIndexAdd(i);
+		}
+	}
+}
+
+/*************************************************************************//**
+*  @brief Clears the pending mark of the entry @a i
+*  @return @c true if the entry was pending, so it is not in the index
+*****************************************************************************/
+static bool nwkRoutePendingClear(NwkRouteIndex_t i)
+{
+	uint8_t mask = (uint8_t)(1 << (i % 8));
+
+	if (0 == (nwkRoutePending[i / 8] & mask)) {
+		return false;
+	}
+
+	nwkRoutePending[i / 8] &= (uint8_t)~mask;
+	nwkRoutePendingAmount--;
+
+	return true;
+}
+
 /*************************************************************************//**
 *****************************************************************************/
-static void nwkRouteNormalizeRanks(void)
+static void nwkRouteLruUnlink(NwkRouteIndex_t i)
 {
-	for (uint8_t i = 0; i < NWK_ROUTE_TABLE_SIZE; i++) {
-		nwkRouteTable[i].rank = (nwkRouteTable[i].rank >> 1) + 1;
+	NwkRouteLruNode_t *node = &nwkRouteLru[i];
+
+	if (NWK_ROUTE_INDEX_NONE == node->prev) {
+		nwkRouteLruHead = node->next;
+	} else {
+		nwkRouteLru[node->prev].next = node->next;
+	}
+
+	if (NWK_ROUTE_INDEX_NONE == node->next) {
+		nwkRouteLruTail = node->prev;
+	} else {
+		nwkRouteLru[node->next].prev = node->prev;
 	}
+
+	node->prev = NWK_ROUTE_INDEX_NONE;
+	node->next = NWK_ROUTE_INDEX_NONE;
 }
 
+/*************************************************************************//**
+*  @brief Inserts the entry @a i into the eviction list, as the most recently
+*  used entry if @a recent is true, or as the first one to be evicted
+*****************************************************************************/
+static void nwkRouteLruInsert(NwkRouteIndex_t i, bool recent)
+{
+	NwkRouteLruNode_t *node = &nwkRouteLru[i];
+
+	if (recent) {
+		node->prev = nwkRouteLruTail;
+		node->next = NWK_ROUTE_INDEX_NONE;
+
+		if (NWK_ROUTE_INDEX_NONE == nwkRouteLruTail) {
+			nwkRouteLruHead = i;
+		} else {
+			nwkRouteLru[nwkRouteLruTail].next = i;
+		}
+
+		nwkRouteLruTail = i;
+	} else {
+		node->prev = NWK_ROUTE_INDEX_NONE;
+		node->next = nwkRouteLruHead;
+
+		if (NWK_ROUTE_INDEX_NONE == nwkRouteLruHead) {
+			nwkRouteLruTail = i;
+		} else {
+			nwkRouteLru[nwkRouteLruHead].prev = i;
+		}
+
+		nwkRouteLruHead = i;
+	}
+}
+
+#ifdef NWK_ENABLE_MULTIPATH
+/*************************************************************************//**
+*  @brief Returns the cost of reaching the destination through the next hop
+*  @a addr, lower is better. With native routing and NWK_ENABLE_ETX this is
+*  the ETX of the link, otherwise the cost is derived from the route LQI.
+*****************************************************************************/
+static uint16_t nwkRouteHopCost(uint16_t addr, uint8_t lqi)
+{
+#if defined(NWK_ENABLE_ETX) && !defined(NWK_ENABLE_ROUTE_DISCOVERY)
+	(void)lqi;
+	return NWK_NeighbourEtx(addr);
+#else
+	(void)addr;
+	return NWK_ROUTE_MAX_LQI - lqi;
+#endif
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static void nwkRouteAlternatesClear(NwkRouteIndex_t i)
+{
+	NwkRouteAlternates_t *alt = &nwkRouteAlternates[i];
+
+	for (uint8_t j = 0; j < NWK_ROUTE_ALTERNATES_AMOUNT; j++) {
+		alt->hop[j].addr = NWK_ROUTE_UNKNOWN;
+	}
+
+  #ifdef NWK_ENABLE_MULTIPATH_BALANCING
+	alt->turn = 0;
+  #endif
+}
+
+/*************************************************************************//**
+*  @brief Inserts the next hop @a addr into the alternates of the entry @a i
+*  according to its cost. The worst alternate is dropped if there is no room.
+*****************************************************************************/
+static void nwkRouteAlternateInsert(NwkRouteIndex_t i, uint16_t addr,
+		uint8_t lqi)
+{
+	NwkRouteAlternates_t *alt = &nwkRouteAlternates[i];
+	uint16_t cost = nwkRouteHopCost(addr, lqi);
+	uint8_t pos, j;
+
+	if (addr == nwkRouteTable[i].nextHopAddr ||
+			NWK_ROUTE_UNKNOWN == addr || NWK_BROADCAST_ADDR == addr) {
+		return;
+	}
+
+	nwkRouteAlternateRemove(i, addr);
+
+	for (pos = 0; pos < NWK_ROUTE_ALTERNATES_AMOUNT; pos++) {
+		NwkRouteHop_t *hop = &alt->hop[pos];
+
+		if (NWK_ROUTE_UNKNOWN == hop->addr ||
+				cost < nwkRouteHopCost(hop->addr, hop->lqi)) {
+			break;
+		}
+	}
+
+	if (NWK_ROUTE_ALTERNATES_AMOUNT == pos) {
+		return;
+	}
+
+	for (j = NWK_ROUTE_ALTERNATES_AMOUNT - 1; j > pos; j--) {
+		alt->hop[j] = alt->hop[j - 1];
+	}
+
+	alt->hop[pos].addr = addr;
+	alt->hop[pos].lqi = lqi;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static void nwkRouteAlternateRemove(NwkRouteIndex_t i, uint16_t addr)
+{
+	NwkRouteAlternates_t *alt = &nwkRouteAlternates[i];
+	uint8_t j;
+
+	for (j = 0; j < NWK_ROUTE_ALTERNATES_AMOUNT; j++) {
+		if (addr == alt->hop[j].addr) {
+			break;
+		}
+	}
+
+	if (NWK_ROUTE_ALTERNATES_AMOUNT == j) {
+		return;
+	}
+
+	for (; j < NWK_ROUTE_ALTERNATES_AMOUNT - 1; j++) {
+		alt->hop[j] = alt->hop[j + 1];
+	}
+
+	alt->hop[NWK_ROUTE_ALTERNATES_AMOUNT - 1].addr = NWK_ROUTE_UNKNOWN;
+}
+
+/*************************************************************************//**
+*  @brief Replaces the failed next hop of the @a entry with its best
+*  alternate. Link costs may have changed since the alternates were ranked,
+*  so the best one is looked up again.
+*  @return @c true if there was an alternate to switch to
+*****************************************************************************/
+static bool nwkRouteFailover(NWK_RouteTableEntry_t *entry)
+{
+	NwkRouteAlternates_t *alt = &nwkRouteAlternates[entry - nwkRouteTable];
+	NwkRouteHop_t *best = NULL;
+	uint16_t bestCost = 0;
+
+	for (uint8_t j = 0; j < NWK_ROUTE_ALTERNATES_AMOUNT; j++) {
+		NwkRouteHop_t *hop = &alt->hop[j];
+		uint16_t cost;
+
+		if (NWK_ROUTE_UNKNOWN == hop->addr) {
+			break;
+		}
+
+		cost = nwkRouteHopCost(hop->addr, hop->lqi);
+
+		if (NULL == best || cost < bestCost) {
+			best = hop;
+			bestCost = cost;
+		}
+	}
+
+	if (NULL == best) {
+		return false;
+	}
+
+	entry->nextHopAddr = best->addr;
+	entry->lqi = best->lqi;
+	entry->score = NWK_ROUTE_DEFAULT_SCORE;
+
+	nwkRouteAlternateRemove(entry - nwkRouteTable, best->addr);
+
+	return true;
+}
+
+#endif /* NWK_ENABLE_MULTIPATH */
+
+#ifdef NWK_ENABLE_MULTIPATH_BALANCING
+/*************************************************************************//**
+*  @brief Selects the next hop for a frame to the destination of the @a entry.
+*  The primary next hop and the alternates that cost at most
+*  NWK_ROUTE_BALANCE_MARGIN more are used in turn.
+*****************************************************************************/
+static uint16_t nwkRouteBalancedNextHop(NWK_RouteTableEntry_t *entry)
+{
+	NwkRouteAlternates_t *alt = &nwkRouteAlternates[entry - nwkRouteTable];
+	uint16_t limit = nwkRouteHopCost(entry->nextHopAddr, entry->lqi) +
+			NWK_ROUTE_BALANCE_MARGIN;
+	uint16_t equal[NWK_ROUTE_ALTERNATES_AMOUNT];
+	uint8_t count = 0;
+
+	if (entry->fixed) {
+		return entry->nextHopAddr;
+	}
+
+	for (uint8_t j = 0; j < NWK_ROUTE_ALTERNATES_AMOUNT; j++) {
+		NwkRouteHop_t *hop = &alt->hop[j];
+
+		if (NWK_ROUTE_UNKNOWN == hop->addr) {
+			break;
+		}
+
+		if (nwkRouteHopCost(hop->addr, hop->lqi) <= limit) {
+			equal[count++] = hop->addr;
+		}
+	}
+
+	if (alt->turn >= count) {
+		alt->turn = 0;
+		return entry->nextHopAddr;
+	}
+
+	return equal[alt->turn++];
+}
+
+#endif /* NWK_ENABLE_MULTIPATH_BALANCING */
+
+#ifdef NWK_ENABLE_EXPANDING_RING
+/*************************************************************************//**
+*****************************************************************************/
+static void nwkRouteConfirm(NwkRouteIndex_t i, bool confirmed)
+{
+	nwkRouteConfirmed[i] = SYS_TimerTime();
+
+	if (!confirmed) {
+		nwkRouteConfirmed[i] -= NWK_ROUTE_DISCOVERY_FRESH_TIME;
+	}
+}
+
+#endif /* NWK_ENABLE_EXPANDING_RING */
+
 #endif /* NWK_ENABLE_ROUTING */
@@ -51,6 +51,7 @@
 #include "nwkGroup.h"
 #include "nwkCommand.h"
 #include "nwkRouteDiscovery.h"
+#include "nwkNeighbour.h"
 
 #ifdef NWK_ENABLE_ROUTE_DISCOVERY
 
@@ -58,10 +59,11 @@
 #define NWK_ROUTE_DISCOVERY_BEST_LINK_QUALITY    255
 #define NWK_ROUTE_DISCOVERY_NO_LINK              0
 #define NWK_ROUTE_DISCOVERY_TIMER_INTERVAL       100 /* ms */
+#define NWK_ROUTE_DISCOVERY_TTL_UNLIMITED        255
 
 /*- Types ------------------------------------------------------------------*/
 enum {
-	NWK_RD_STATE_WAIT_FOR_ROUTE = 0x40,
+	NWK_RD_STATE_WAIT_FOR_ROUTE = NWK_FRAME_STATE_RD_BASE,
 };
 
 typedef struct NwkRouteDiscoveryTableEntry_t {
@@ -71,6 +73,7 @@ typedef struct NwkRouteDiscoveryTableEntry_t {
 	uint16_t senderAddr;
 	uint8_t forwardLinkQuality;
 	uint8_t reverseLinkQuality;
+	uint8_t ttl;
 	uint16_t timeout;
 } NwkRouteDiscoveryTableEntry_t;
 
@@ -85,7 +88,15 @@ static void nwkRouteDiscoverySendReply(NwkRouteDiscoveryTableEntry_t *entry,
 		uint8_t flq, uint8_t rlq);
 static void nwkRouteDiscoveryDone(NwkRouteDiscoveryTableEntry_t *entry,
 		bool status);
-static uint8_t nwkRouteDiscoveryUpdateLq(uint8_t lqa, uint8_t lqb);
+static uint8_t nwkRouteDiscoveryUpdateLq(uint8_t lq, NWK_DataInd_t *ind);
+static uint8_t nwkRouteDiscoveryNextTtl(uint8_t ttl);
+#ifdef NWK_ENABLE_EXPANDING_RING
+static uint16_t nwkRouteDiscoveryRingTimeout(uint8_t ttl);
+static bool nwkRouteDiscoveryExpandRing(NwkRouteDiscoveryTableEntry_t *entry);
+static NWK_RouteTableEntry_t *nwkRouteDiscoveryFreshRoute(
+		NwkCommandRouteRequest_t *command, NWK_DataInd_t *ind);
+static uint8_t nwkRouteDiscoveryJoinLq(uint8_t lq, uint8_t routeLq);
+#endif
 
 /*- Variables --------------------------------------------------------------*/
 static NwkRouteDiscoveryTableEntry_t nwkRouteDiscoveryTable[
@@ -119,7 +130,7 @@ void nwkRouteDiscoveryRequest(NwkFrame_t *frame)
 			header->nwkFcf.multicast);
 
 	if (entry) {
-		frame->state = NWK_RD_STATE_WAIT_FOR_ROUTE;
+		nwkFrameSetState(frame, NWK_RD_STATE_WAIT_FOR_ROUTE);
 		return;
 	}
 
@@ -130,10 +141,16 @@ void nwkRouteDiscoveryRequest(NwkFrame_t *frame)
 		entry->dstAddr = header->nwkDstAddr;
 		entry->multicast = header->nwkFcf.multicast;
 		entry->senderAddr = NWK_BROADCAST_ADDR;
+#ifdef NWK_ENABLE_EXPANDING_RING
+		entry->ttl = NWK_ROUTE_DISCOVERY_TTL_START;
+		entry->timeout = nwkRouteDiscoveryRingTimeout(entry->ttl);
+#else
+		entry->ttl = NWK_ROUTE_DISCOVERY_TTL_UNLIMITED;
+#endif
 
 		if (nwkRouteDiscoverySendRequest(entry,
 				NWK_ROUTE_DISCOVERY_BEST_LINK_QUALITY)) {
-			frame->state = NWK_RD_STATE_WAIT_FOR_ROUTE;
+			nwkFrameSetState(frame, NWK_RD_STATE_WAIT_FOR_ROUTE);
 			return;
 		}
 	}
@@ -195,10 +212,17 @@ static void nwkRouteDiscoveryTimerHandler(SYS_Timer_t *timer)
 		if (entry->timeout > NWK_ROUTE_DISCOVERY_TIMER_INTERVAL) {
 			entry->timeout -= NWK_ROUTE_DISCOVERY_TIMER_INTERVAL;
 			restart = true;
-		} else {
+		} else if (entry->timeout > 0) {
 			entry->timeout = 0;
 
 			if (entry->srcAddr == nwkIb.addr) {
+#ifdef NWK_ENABLE_EXPANDING_RING
+				if (0 == entry->reverseLinkQuality &&
+						nwkRouteDiscoveryExpandRing(entry)) {
+					restart = true;
+					continue;
+				}
+#endif
 				nwkRouteDiscoveryDone(entry,
 						entry->reverseLinkQuality >
 						0);
@@ -218,14 +242,21 @@ static bool nwkRouteDiscoverySendRequest(NwkRouteDiscoveryTableEntry_t *entry,
 {
 	NwkFrame_t *req;
 	NwkCommandRouteRequest_t *command;
+	uint8_t size = sizeof(NwkCommandRouteRequest_t);
+
+	/* Requests that are not limited in hops go without the TTL, so that
+	 * nodes that do not know it still accept them */
+	if (NWK_ROUTE_DISCOVERY_TTL_UNLIMITED == entry->ttl) {
+		size--;
+	}
 
-	if (NULL == (req = nwkFrameAlloc())) {
+	if (NULL == (req = nwkFrameAlloc(NWK_FRAME_CLASS_COMMAND, size))) {
 		return false;
 	}
 
 	nwkFrameCommandInit(req);
 
-	req->size += sizeof(NwkCommandRouteRequest_t);
+	req->size += size;
 	req->tx.confirm = NULL;
 
 	req->header.nwkFcf.linkLocal = 1;
@@ -238,6 +269,10 @@ static bool nwkRouteDiscoverySendRequest(NwkRouteDiscoveryTableEntry_t *entry,
 	command->multicast = entry->multicast;
 	command->linkQuality = lq;
 
+	if (sizeof(NwkCommandRouteRequest_t) == size) {
+		command->ttl = entry->ttl;
+	}
+
 	nwkTxFrame(req);
 
 	return true;
@@ -251,9 +286,17 @@ bool nwkRouteDiscoveryRequestReceived(NWK_DataInd_t *ind)
 		= (NwkCommandRouteRequest_t *)ind->data;
 	NwkRouteDiscoveryTableEntry_t *entry;
 	uint8_t linkQuality;
+	uint8_t ttl;
 	bool reply = false;
+#ifdef NWK_ENABLE_EXPANDING_RING
+	NWK_RouteTableEntry_t *route;
+#endif
 
-	if (sizeof(NwkCommandRouteRequest_t) != ind->size) {
+	if (sizeof(NwkCommandRouteRequest_t) == ind->size) {
+		ttl = command->ttl;
+	} else if (sizeof(NwkCommandRouteRequest_t) - 1 == ind->size) {
+		ttl = NWK_ROUTE_DISCOVERY_TTL_UNLIMITED;
+	} else {
 		return false;
 	}
 
@@ -275,13 +318,30 @@ bool nwkRouteDiscoveryRequestReceived(NWK_DataInd_t *ind)
 		return true;
 	}
 
-	linkQuality = nwkRouteDiscoveryUpdateLq(command->linkQuality, ind->lqi);
+	linkQuality = nwkRouteDiscoveryUpdateLq(command->linkQuality, ind);
 
 	entry = nwkRouteDiscoveryFindEntry(command->srcAddr, command->dstAddr,
 			command->multicast);
 
 	if (entry) {
+		/* A request of a larger ring is flooded again even if it is not
+		 * better, since it may reach further than the one before */
+		if (!reply && ttl > entry->ttl + 1 &&
+				linkQuality <= entry->forwardLinkQuality) {
+			entry->ttl = nwkRouteDiscoveryNextTtl(ttl);
+			entry->timeout = NWK_ROUTE_DISCOVERY_TIMEOUT;
+			nwkRouteDiscoverySendRequest(entry,
+					entry->forwardLinkQuality);
+			return true;
+		}
+
 		if (linkQuality <= entry->forwardLinkQuality) {
+#ifdef NWK_ENABLE_MULTIPATH
+			if (reply) {
+				nwkRouteAddAlternate(command->srcAddr, 0,
+						ind->srcAddr, linkQuality);
+			}
+#endif
 			return true;
 		}
 	} else {
@@ -295,13 +355,25 @@ bool nwkRouteDiscoveryRequestReceived(NWK_DataInd_t *ind)
 	entry->multicast = command->multicast;
 	entry->senderAddr = ind->srcAddr;
 	entry->forwardLinkQuality = linkQuality;
+	entry->ttl = nwkRouteDiscoveryNextTtl(ttl);
 
 	if (reply) {
 		nwkRouteUpdateEntry(command->srcAddr, 0, ind->srcAddr,
 				linkQuality);
 		nwkRouteDiscoverySendReply(entry, linkQuality,
 				NWK_ROUTE_DISCOVERY_BEST_LINK_QUALITY);
-	} else {
+	}
+#ifdef NWK_ENABLE_EXPANDING_RING
+	/* Answer on behalf of the destination and stop the flood here */
+	else if (NULL != (route = nwkRouteDiscoveryFreshRoute(command, ind))) {
+		nwkRouteUpdateEntry(command->srcAddr, 0, ind->srcAddr,
+				linkQuality);
+		nwkRouteDiscoverySendReply(entry,
+				nwkRouteDiscoveryJoinLq(linkQuality, route->lqi),
+				route->lqi);
+	}
+#endif
+	else if (entry->ttl > 0) {
 		nwkRouteDiscoverySendRequest(entry, linkQuality);
 	}
 
@@ -316,7 +388,8 @@ static void nwkRouteDiscoverySendReply(NwkRouteDiscoveryTableEntry_t *entry,
 	NwkFrame_t *req;
 	NwkCommandRouteReply_t *command;
 
-	if (NULL == (req = nwkFrameAlloc())) {
+	if (NULL == (req = nwkFrameAlloc(NWK_FRAME_CLASS_COMMAND,
+			sizeof(NwkCommandRouteReply_t)))) {
 		return;
 	}
 
@@ -355,7 +428,7 @@ bool nwkRouteDiscoveryReplyReceived(NWK_DataInd_t *ind)
 			command->multicast);
 
 	linkQuality = nwkRouteDiscoveryUpdateLq(command->reverseLinkQuality,
-			ind->lqi);
+			ind);
 
 	if (entry && command->forwardLinkQuality > entry->reverseLinkQuality) {
 		entry->reverseLinkQuality = command->forwardLinkQuality;
@@ -377,6 +450,14 @@ bool nwkRouteDiscoveryReplyReceived(NWK_DataInd_t *ind)
 					linkQuality);
 		}
 	}
+#ifdef NWK_ENABLE_MULTIPATH
+	else if (entry) {
+		/* Paths found by the weaker replies serve as alternates */
+		nwkRouteAddAlternate(command->dstAddr, command->multicast,
+				ind->srcAddr, (command->srcAddr == nwkIb.addr) ?
+				command->forwardLinkQuality : linkQuality);
+	}
+#endif
 
 	return true;
 }
@@ -386,12 +467,11 @@ bool nwkRouteDiscoveryReplyReceived(NWK_DataInd_t *ind)
 static void nwkRouteDiscoveryDone(NwkRouteDiscoveryTableEntry_t *entry,
 		bool status)
 {
-	NwkFrame_t *frame = NULL;
+	NwkFrame_t *frame, *next;
 
-	while (NULL != (frame = nwkFrameNext(frame))) {
-		if (NWK_RD_STATE_WAIT_FOR_ROUTE != frame->state) {
-			continue;
-		}
+	for (frame = nwkFrameFirst(NWK_RD_STATE_WAIT_FOR_ROUTE); frame;
+			frame = next) {
+		next = nwkFrameNext(frame);
 
 		if (entry->dstAddr != frame->header.nwkDstAddr ||
 				entry->multicast !=
@@ -408,10 +488,116 @@ static void nwkRouteDiscoveryDone(NwkRouteDiscoveryTableEntry_t *entry,
 }
 
 /*************************************************************************//**
+*  @brief Accumulates the path quality @a lq with the quality of the link to
+*  the sender of the command @a ind
+*****************************************************************************/
+static uint8_t nwkRouteDiscoveryUpdateLq(uint8_t lq, NWK_DataInd_t *ind)
+{
+#ifdef NWK_ENABLE_ETX
+	/* The path quality is the best quality less the path ETX in units of
+	 * 1/4 transmissions, so that link costs add up along the path */
+	uint16_t cost = (NWK_NeighbourEtx(ind->srcAddr) + 2) / 4;
+
+	return (lq > cost) ? lq - cost : NWK_ROUTE_DISCOVERY_NO_LINK + 1;
+#else
+	return ((uint16_t)lq * ind->lqi) >> 8;
+#endif
+}
+
+/*************************************************************************//**
+*  @brief Returns the TTL a request received with the @a ttl is forwarded with
+*****************************************************************************/
+static uint8_t nwkRouteDiscoveryNextTtl(uint8_t ttl)
+{
+	if (NWK_ROUTE_DISCOVERY_TTL_UNLIMITED == ttl || 0 == ttl) {
+		return ttl;
+	}
+
+	return ttl - 1;
+}
+
+#ifdef NWK_ENABLE_EXPANDING_RING
+/*************************************************************************//**
+*  @brief Returns the time to wait for replies to a request with the @a ttl.
+*  The last ring covers the whole network and gets the full timeout.
 *****************************************************************************/
-static uint8_t nwkRouteDiscoveryUpdateLq(uint8_t lqa, uint8_t lqb)
+static uint16_t nwkRouteDiscoveryRingTimeout(uint8_t ttl)
 {
-	return ((uint16_t)lqa * lqb) >> 8;
+	if (NWK_ROUTE_DISCOVERY_TTL_UNLIMITED == ttl) {
+		return NWK_ROUTE_DISCOVERY_TIMEOUT;
+	}
+
+	return (uint16_t)ttl * NWK_ROUTE_DISCOVERY_RING_TIMEOUT;
 }
 
+/*************************************************************************//**
+*  @brief Repeats the unanswered request of the originator @a entry with a
+*  larger TTL. Once the TTL exceeds NWK_ROUTE_DISCOVERY_TTL_THRESHOLD the
+*  request is flooded through the whole network.
+*  @return @c false if the whole network was searched already
+*****************************************************************************/
+static bool nwkRouteDiscoveryExpandRing(NwkRouteDiscoveryTableEntry_t *entry)
+{
+	if (NWK_ROUTE_DISCOVERY_TTL_UNLIMITED == entry->ttl) {
+		return false;
+	}
+
+	entry->ttl += NWK_ROUTE_DISCOVERY_TTL_INCREMENT;
+
+	if (entry->ttl > NWK_ROUTE_DISCOVERY_TTL_THRESHOLD) {
+		entry->ttl = NWK_ROUTE_DISCOVERY_TTL_UNLIMITED;
+	}
+
+	entry->timeout = nwkRouteDiscoveryRingTimeout(entry->ttl);
+
+	/* Without a buffer the request is repeated with a larger TTL after
+	 * the timeout */
+	nwkRouteDiscoverySendRequest(entry,
+			NWK_ROUTE_DISCOVERY_BEST_LINK_QUALITY);
+
+	return true;
+}
+
+/*************************************************************************//**
+*  @brief Finds a route that lets this node answer the request @a command on
+*  behalf of its destination. The route must be fresh and must not lead back
+*  towards the originator of the request.
+*****************************************************************************/
+static NWK_RouteTableEntry_t *nwkRouteDiscoveryFreshRoute(
+		NwkCommandRouteRequest_t *command, NWK_DataInd_t *ind)
+{
+	NWK_RouteTableEntry_t *route;
+
+	if (command->multicast) {
+		return NULL;
+	}
+
+	route = NWK_RouteFindEntry(command->dstAddr, 0);
+
+	if (NULL == route || !nwkRouteIsFresh(route) ||
+			route->nextHopAddr == ind->srcAddr ||
+			route->nextHopAddr == command->srcAddr) {
+		return NULL;
+	}
+
+	return route;
+}
+
+/*************************************************************************//**
+*  @brief Accumulates the path quality @a lq up to this node with the quality
+*  @a routeLq of the known route to the destination
+*****************************************************************************/
+static uint8_t nwkRouteDiscoveryJoinLq(uint8_t lq, uint8_t routeLq)
+{
+#ifdef NWK_ENABLE_ETX
+	uint8_t cost = NWK_ROUTE_DISCOVERY_BEST_LINK_QUALITY - routeLq;
+
+	return (lq > cost) ? lq - cost : NWK_ROUTE_DISCOVERY_NO_LINK + 1;
+#else
+	return ((uint16_t)lq * routeLq) >> 8;
+#endif
+}
+
+#endif /* NWK_ENABLE_EXPANDING_RING */
+
 #endif /* NWK_ENABLE_ROUTE_DISCOVERY */
@@ -40,6 +40,7 @@
 
 /*- Includes ---------------------------------------------------------------*/
 #include <stdlib.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
@@ -51,42 +52,49 @@
 #include "nwkFrame.h"
 #include "nwkGroup.h"
 #include "nwkRoute.h"
+#include "nwkNeighbour.h"
 #include "nwkCommand.h"
 #include "nwkSecurity.h"
 #include "nwkRouteDiscovery.h"
+#include "nwkFrag.h"
+#include "nwkStream.h"
 
 /*- Definitions ------------------------------------------------------------*/
-#define NWK_RX_DUPLICATE_REJECTION_TIMER_INTERVAL   100 /* ms */
-#define DUPLICATE_REJECTION_TTL	\
-	((NWK_DUPLICATE_REJECTION_TTL /	\
-	NWK_RX_DUPLICATE_REJECTION_TIMER_INTERVAL) + 1)
-#define NWK_SERVICE_ENDPOINT_ID    0
+#define NWK_RX_DUPLICATE_REJECTION_PROBES           4
 
 /*- Types ------------------------------------------------------------------*/
 enum {
-	NWK_RX_STATE_RECEIVED = 0x20,
-	NWK_RX_STATE_DECRYPT  = 0x21,
-	NWK_RX_STATE_INDICATE = 0x22,
-	NWK_RX_STATE_ROUTE    = 0x23,
-	NWK_RX_STATE_FINISH   = 0x24,
+	NWK_RX_STATE_RECEIVED = NWK_FRAME_STATE_RX_BASE,
+	NWK_RX_STATE_DECRYPT,
+	NWK_RX_STATE_INDICATE,
+	NWK_RX_STATE_ROUTE,
+	NWK_RX_STATE_FINISH,
 };
 
-typedef struct NwkDuplicateRejectionEntry_t {
-	uint16_t src;
-	uint8_t seq;
-	uint8_t mask;
-	uint8_t ttl;
-} NwkDuplicateRejectionEntry_t;
-
 /*- Prototypes -------------------------------------------------------------*/
 static void nwkRxDuplicateRejectionTimerHandler(SYS_Timer_t *timer);
+static void nwkRxBroadcastFrame(NwkFrame_t *frame);
+static bool nwkRxExpandHeader(NwkFrame_t *frame);
 static bool nwkRxSeriveDataInd(NWK_DataInd_t *ind);
+static bool nwkRxIndicateAggregate(NWK_DataInd_t *ind);
+#ifdef NWK_ENABLE_DELAYED_ACK
+static void nwkRxAckTimerHandler(SYS_Timer_t *timer);
+static void nwkRxFlushAck(void);
+#endif
 
 /*- Variables --------------------------------------------------------------*/
-static NwkDuplicateRejectionEntry_t nwkRxDuplicateRejectionTable[
+static NWK_DuplicateRejectionEntry_t nwkRxDuplicateRejectionStorage[
 	NWK_DUPLICATE_REJECTION_TABLE_SIZE];
+static NWK_DuplicateRejectionEntry_t *nwkRxDuplicateRejectionTable;
+static uint16_t nwkRxDuplicateRejectionTableSize;
 static uint8_t nwkRxAckControl;
 static SYS_Timer_t nwkRxDuplicateRejectionTimer;
+static NwkFrame_t *nwkRxBufferFrame;
+static bool nwkRxBufferRequested;
+#ifdef NWK_ENABLE_DELAYED_ACK
+static NwkFrame_t *nwkRxAckFrame;
+static SYS_Timer_t nwkRxAckTimer;
+#endif
 
 /*- Implementations --------------------------------------------------------*/
 
@@ -95,12 +103,20 @@ static SYS_Timer_t nwkRxDuplicateRejectionTimer;
 *****************************************************************************/
 void nwkRxInit(void)
 {
-	for (uint8_t i = 0; i < NWK_DUPLICATE_REJECTION_TABLE_SIZE; i++) {
-		nwkRxDuplicateRejectionTable[i].ttl = 0;
-	}
+	NWK_SetDuplicateRejectionTable(nwkRxDuplicateRejectionStorage,
+			NWK_DUPLICATE_REJECTION_TABLE_SIZE);
+
+	nwkRxBufferFrame = NULL;
+	nwkRxBufferRequested = false;
 
-	nwkRxDuplicateRejectionTimer.interval
-		= NWK_RX_DUPLICATE_REJECTION_TIMER_INTERVAL;
+#ifdef NWK_ENABLE_DELAYED_ACK
+	nwkRxAckFrame = NULL;
+	nwkRxAckTimer.interval = NWK_DELAYED_ACK_TIME;
+	nwkRxAckTimer.mode = SYS_TIMER_INTERVAL_MODE;
+	nwkRxAckTimer.handler = nwkRxAckTimerHandler;
+#endif
+
+	nwkRxDuplicateRejectionTimer.interval = NWK_DUPLICATE_REJECTION_TTL;
 	nwkRxDuplicateRejectionTimer.mode = SYS_TIMER_INTERVAL_MODE;
 	nwkRxDuplicateRejectionTimer.handler
 		= nwkRxDuplicateRejectionTimerHandler;
@@ -108,39 +124,180 @@ void nwkRxInit(void)
 	NWK_OpenEndpoint(NWK_SERVICE_ENDPOINT_ID, nwkRxSeriveDataInd);
 }
 
+/*************************************************************************//**
+*  @brief Lends a free frame to the PHY so that a received frame is read
+*  directly into it
+*  @return Pointer to the frame length field followed by the frame data or
+*  @c NULL if there are no free frames
+*****************************************************************************/
+uint8_t *PHY_DataIndBuffer(void)
+{
+	nwkRxBufferRequested = true;
+	nwkRxBufferFrame = nwkFrameAlloc(NWK_FRAME_CLASS_RX,
+			NWK_MAX_PAYLOAD_SIZE);
+
+	if (NULL == nwkRxBufferFrame) {
+		return NULL;
+	}
+
+	return &nwkRxBufferFrame->size;
+}
+
 /*************************************************************************//**
 *****************************************************************************/
 void PHY_DataInd(PHY_DataInd_t *ind)
 {
-	NwkFrame_t *frame;
+	NwkFrame_t *frame = nwkRxBufferFrame;
+	bool requested = nwkRxBufferRequested;
+
+	nwkRxBufferFrame = NULL;
+	nwkRxBufferRequested = false;
 
 	if (0x88 != ind->data[1] ||
 			(0x61 != ind->data[0] && 0x41 != ind->data[0]) ||
-			ind->size < sizeof(NwkFrameHeader_t)) {
+			ind->size < offsetof(NwkFrameHeader_t, nwkSeq)) {
+		if (frame) {
+			nwkFrameFree(frame);
+		}
+
 		return;
 	}
 
-	if (NULL == (frame = nwkFrameAlloc())) {
-		return;
+	if (NULL == frame) {
+		/* A failed buffer request has already found the pool empty */
+		if (requested) {
+			return;
+		}
+
+		if (NULL == (frame = nwkFrameAlloc(NWK_FRAME_CLASS_RX,
+				NWK_MAX_PAYLOAD_SIZE))) {
+			return;
+		}
+
+		memcpy(frame->data, ind->data, ind->size);
 	}
 
-	frame->state = NWK_RX_STATE_RECEIVED;
 	frame->size = ind->size;
+
+	if (!nwkRxExpandHeader(frame)) {
+		nwkFrameFree(frame);
+		return;
+	}
+
+	nwkFrameSetState(frame, NWK_RX_STATE_RECEIVED);
 	frame->rx.lqi = ind->lqi;
 	frame->rx.rssi = ind->rssi;
-	memcpy(frame->data, ind->data, ind->size);
 }
 
 /*************************************************************************//**
+*  @brief Restores the NWK addresses removed from the header by the sender
+*  @param[in] frame Pointer to the received frame
+*  @return @c true if the frame has a complete header, @c false otherwise
+*
+*  The removed addresses are equal to the corresponding MAC addresses.
+*  Frames with a full header are accepted as is.
+*****************************************************************************/
+static bool nwkRxExpandHeader(NwkFrame_t *frame)
+{
+	NwkFrameHeader_t *header = &frame->header;
+	uint8_t offset = offsetof(NwkFrameHeader_t, nwkDstAddr);
+	uint8_t elided = 0;
+
+	if (header->nwkFcf.srcElided) {
+		offset = offsetof(NwkFrameHeader_t, nwkSrcAddr);
+		elided += sizeof(uint16_t);
+	}
+
+	if (header->nwkFcf.dstElided) {
+		elided += sizeof(uint16_t);
+	}
+
+	if (frame->size + elided < sizeof(NwkFrameHeader_t) ||
+			frame->size + elided > NWK_FRAME_MAX_PAYLOAD_SIZE -
+			PHY_CRC_SIZE) {
+		return false;
+	}
+
+	if (0 == elided) {
+		return true;
+	}
+
+	memmove(frame->data + offset + elided, frame->data + offset,
+			frame->size - offset);
+	frame->size += elided;
+
+	if (header->nwkFcf.srcElided) {
+		header->nwkSrcAddr = header->macSrcAddr;
+	}
+
+	if (header->nwkFcf.dstElided) {
+		header->nwkDstAddr = header->macDstAddr;
+	}
+
+	header->nwkFcf.srcElided = 0;
+	header->nwkFcf.dstElided = 0;
+
+	return true;
+}
+
+/*************************************************************************//**
+*  @brief Acknowledges the received @a frame
+*  @param[in] frame Pointer to the received frame
+*
+*  With NWK_ENABLE_DELAYED_ACK the ACK is held for NWK_DELAYED_ACK_TIME and
+*  the sequence numbers of the following frames from the same source are
+*  appended to it, up to NWK_DELAYED_ACK_AMOUNT in total. A frame from
+*  a different source or with a different ACK control value sends the held
+*  ACK right away.
 *****************************************************************************/
 static void nwkRxSendAck(NwkFrame_t *frame)
 {
 	NwkFrame_t *ack;
 	NwkCommandAck_t *command;
 
-	if (NULL == (ack = nwkFrameAlloc())) {
+#ifdef NWK_ENABLE_DELAYED_ACK
+	if (nwkRxAckFrame) {
+		command = (NwkCommandAck_t *)nwkRxAckFrame->payload;
+
+		if (nwkRxAckFrame->header.nwkDstAddr ==
+				frame->header.nwkSrcAddr &&
+				nwkRxAckFrame->header.nwkFcf.security ==
+				frame->header.nwkFcf.security &&
+				command->control == nwkRxAckControl) {
+			uint8_t size = nwkFramePayloadSize(nwkRxAckFrame);
+
+			for (uint8_t i = sizeof(NwkCommandAck_t); i < size; i++) {
+				if (nwkRxAckFrame->payload[i] == frame->header.nwkSeq) {
+					return;
+				}
+			}
+
+			if (command->seq != frame->header.nwkSeq) {
+				nwkRxAckFrame->payload[size] = frame->header.nwkSeq;
+				nwkRxAckFrame->size++;
+			}
+
+			if (nwkFramePayloadSize(nwkRxAckFrame) ==
+					sizeof(NwkCommandAck_t) + NWK_DELAYED_ACK_AMOUNT - 1) {
+				nwkRxFlushAck();
+			}
+
+			return;
+		}
+
+		nwkRxFlushAck();
+	}
+
+	if (NULL == (ack = nwkFrameAlloc(NWK_FRAME_CLASS_COMMAND,
+			sizeof(NwkCommandAck_t) + NWK_DELAYED_ACK_AMOUNT - 1))) {
+		return;
+	}
+#else
+	if (NULL == (ack = nwkFrameAlloc(NWK_FRAME_CLASS_COMMAND,
+			sizeof(NwkCommandAck_t)))) {
 		return;
 	}
+#endif
 
 	nwkFrameCommandInit(ack);
 
@@ -155,9 +312,42 @@ static void nwkRxSendAck(NwkFrame_t *frame)
 	command->control = nwkRxAckControl;
 	command->seq = frame->header.nwkSeq;
 
+#ifdef NWK_ENABLE_DELAYED_ACK
+	if (NWK_DELAYED_ACK_AMOUNT > 1) {
+		nwkRxAckFrame = ack;
+		SYS_TimerStart(&nwkRxAckTimer);
+		return;
+	}
+#endif
+
 	nwkTxFrame(ack);
 }
 
+#ifdef NWK_ENABLE_DELAYED_ACK
+
+/*************************************************************************//**
+*  @brief Sends the held ACK
+*****************************************************************************/
+static void nwkRxFlushAck(void)
+{
+	SYS_TimerStop(&nwkRxAckTimer);
+	nwkTxFrame(nwkRxAckFrame);
+	nwkRxAckFrame = NULL;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static void nwkRxAckTimerHandler(SYS_Timer_t *timer)
+{
+	if (nwkRxAckFrame) {
+		nwkRxFlushAck();
+	}
+
+	(void)timer;
+}
+
+#endif
+
 /*************************************************************************//**
 *****************************************************************************/
 void NWK_SetAckControl(uint8_t control)
@@ -165,6 +355,24 @@ void NWK_SetAckControl(uint8_t control)
 	nwkRxAckControl = control;
 }
 
+/*************************************************************************//**
+*  @brief Replaces the storage used for the duplicate rejection table, so that
+*  the table can be sized for the network at run time. All entries are
+*  cleared. Must not be called from the data indication callback.
+*  @param[in] table Pointer to the application provided storage
+*  @param[in] size  Number of entries in the @a table
+*****************************************************************************/
+void NWK_SetDuplicateRejectionTable(NWK_DuplicateRejectionEntry_t *table,
+		uint16_t size)
+{
+	for (uint16_t i = 0; i < size; i++) {
+		table[i].mask = 0;
+	}
+
+	nwkRxDuplicateRejectionTable = table;
+	nwkRxDuplicateRejectionTableSize = size;
+}
+
 #ifdef NWK_ENABLE_SECURITY
 
 /*************************************************************************//**
@@ -172,24 +380,114 @@ void NWK_SetAckControl(uint8_t control)
 void nwkRxDecryptConf(NwkFrame_t *frame, bool status)
 {
 	if (status) {
-		frame->state = NWK_RX_STATE_INDICATE;
+		nwkFrameSetState(frame, NWK_RX_STATE_INDICATE);
 	} else {
-		frame->state = NWK_RX_STATE_FINISH;
+		nwkRxForgetDuplicate(&frame->header);
+		nwkFrameSetState(frame, NWK_RX_STATE_FINISH);
 	}
 }
 
 #endif
 
 /*************************************************************************//**
+*  @brief Returns true if the duplicate rejection table @a entry has not
+*  expired at time @a now
+*****************************************************************************/
+static inline bool nwkRxDuplicateEntryValid(
+		NWK_DuplicateRejectionEntry_t *entry, uint32_t now)
+{
+	return entry->mask && (int32_t)(entry->expiry - now) > 0;
+}
+
+/*************************************************************************//**
+*  @brief Returns the index of the first table entry that may hold the source
+*  address @a src
+*****************************************************************************/
+static inline uint16_t nwkRxDuplicateHash(uint16_t src)
+{
+	/* Fold the upper byte in, so that both sequential and structured
+	 * address assignments are spread over the table */
+	return (uint16_t)(src ^ (src >> 8) ^ (src >> 3)) %
+	       nwkRxDuplicateRejectionTableSize;
+}
+
+/*************************************************************************//**
+*  @brief Finds the entry for the source address @a src. Only the probe
+*  window starting at the hash of @a src is searched.
+*  @param[in]  src    Source address
+*  @param[in]  now    Current time
+*  @param[out] victim Entry to be used for @a src if no entry was found: an
+*  expired entry or the one closest to expiry. May be NULL.
+*  @return Pointer to the entry or NULL if there is none
+*****************************************************************************/
+static NWK_DuplicateRejectionEntry_t *nwkRxDuplicateFind(uint16_t src,
+		uint32_t now, NWK_DuplicateRejectionEntry_t **victim)
+{
+	NWK_DuplicateRejectionEntry_t *entry;
+	NWK_DuplicateRejectionEntry_t *oldest = NULL;
+	uint16_t index, probes;
+
+	if (0 == nwkRxDuplicateRejectionTableSize) {
+		if (victim) {
+			*victim = NULL;
+		}
+
+		return NULL;
+	}
+
+	index = nwkRxDuplicateHash(src);
+	probes = NWK_RX_DUPLICATE_REJECTION_PROBES;
+
+	if (probes > nwkRxDuplicateRejectionTableSize) {
+		probes = nwkRxDuplicateRejectionTableSize;
+	}
+
+	for (uint16_t i = 0; i < probes; i++) {
+		entry = &nwkRxDuplicateRejectionTable[index];
+
+		if (nwkRxDuplicateEntryValid(entry, now)) {
+			if (src == entry->src) {
+				return entry;
+			}
+
+			if (NULL == oldest || (oldest->mask &&
+					(int32_t)(entry->expiry - oldest->expiry) < 0)) {
+				oldest = entry;
+			}
+		} else {
+			oldest = entry;
+			entry->mask = 0;
+		}
+
+		if (++index == nwkRxDuplicateRejectionTableSize) {
+			index = 0;
+		}
+	}
+
+	if (victim) {
+		*victim = oldest;
+	}
+
+	return NULL;
+}
+
+/*************************************************************************//**
+*  @brief Clears expired entries of the duplicate rejection table, so that
+*  they are not mistaken for valid ones after the system time wraps around
 *****************************************************************************/
 static void nwkRxDuplicateRejectionTimerHandler(SYS_Timer_t *timer)
 {
+	uint32_t now = SYS_TimerTime();
 	bool restart = false;
 
-	for (uint8_t i = 0; i < NWK_DUPLICATE_REJECTION_TABLE_SIZE; i++) {
-		if (nwkRxDuplicateRejectionTable[i].ttl) {
-			nwkRxDuplicateRejectionTable[i].ttl--;
+	for (uint16_t i = 0; i < nwkRxDuplicateRejectionTableSize; i++) {
+		NWK_DuplicateRejectionEntry_t *entry =
+				&nwkRxDuplicateRejectionTable[i];
+
+		if (nwkRxDuplicateEntryValid(entry, now)) {
 			restart = true;
+		} else {
+			entry->mask = 0;
 		}
 	}
 
@@ -199,61 +497,134 @@ static void nwkRxDuplicateRejectionTimerHandler(SYS_Timer_t *timer)
 }
 
 /*************************************************************************//**
+*  @brief Checks whether the frame with the @a header was already received.
+*  If the table has no room for a new source, the entry closest to expiry is
+*  replaced, so frames from new sources are never rejected.
+*  @param[in] header Pointer to the frame header
+*  @return true if the frame is a duplicate and must be dropped
 *****************************************************************************/
 static bool nwkRxRejectDuplicate(NwkFrameHeader_t *header)
 {
-	NwkDuplicateRejectionEntry_t *entry;
-	NwkDuplicateRejectionEntry_t *freeEntry = NULL;
+	NWK_DuplicateRejectionEntry_t *entry, *victim;
+	uint32_t now = SYS_TimerTime();
 
-	for (uint8_t i = 0; i < NWK_DUPLICATE_REJECTION_TABLE_SIZE; i++) {
-		entry = &nwkRxDuplicateRejectionTable[i];
+	entry = nwkRxDuplicateFind(header->nwkSrcAddr, now, &victim);
 
-		if (entry->ttl && header->nwkSrcAddr == entry->src) {
-			uint8_t diff = (int8_t)entry->seq - header->nwkSeq;
+	if (entry) {
+		uint8_t diff = (int8_t)entry->seq - header->nwkSeq;
 
-			if (diff < 8) {
-				if (entry->mask & (1 << diff)) {
+		if (diff < 8) {
+			if (entry->mask & (1 << diff)) {
 	#ifdef NWK_ENABLE_ROUTING
-					if (nwkIb.addr == header->macDstAddr) {
-						nwkRouteRemove(
-								header->nwkDstAddr,
-								header->nwkFcf.multicast);
-					}
-	#endif
-					return true;
+				if (nwkIb.addr == header->macDstAddr) {
+					nwkRouteRemove(header->nwkDstAddr,
+							header->nwkFcf.multicast);
 				}
+	#endif
+				return true;
+			}
 
-				entry->mask |= (1 << diff);
-				return false;
-			} else {
-				uint8_t shift = -(int8_t)diff;
+			entry->mask |= (1 << diff);
+		} else {
+			uint8_t shift = -(int8_t)diff;
 
-				entry->seq = header->nwkSeq;
-				entry->mask = (entry->mask << shift) | 1;
-				entry->ttl = DUPLICATE_REJECTION_TTL;
-				return false;
-			}
+			entry->seq = header->nwkSeq;
+			entry->mask = (shift < 8) ? (entry->mask << shift) | 1 : 1;
+			entry->ackMask = (shift < 8) ? entry->ackMask << shift : 0;
+			entry->expiry = now + NWK_DUPLICATE_REJECTION_TTL;
 		}
 
-		if (0 == entry->ttl) {
-			freeEntry = entry;
-		}
+		return false;
 	}
 
-	if (NULL == freeEntry) {
-		return true;
+	if (NULL == victim) {
+		return false;
 	}
 
-	freeEntry->src = header->nwkSrcAddr;
-	freeEntry->seq = header->nwkSeq;
-	freeEntry->mask = 1;
-	freeEntry->ttl = DUPLICATE_REJECTION_TTL;
+	victim->src = header->nwkSrcAddr;
+	victim->seq = header->nwkSeq;
+	victim->mask = 1;
+	victim->ackMask = 0;
+	victim->expiry = now + NWK_DUPLICATE_REJECTION_TTL;
 
 	SYS_TimerStart(&nwkRxDuplicateRejectionTimer);
 
 	return false;
 }
 
+/*************************************************************************//**
+*  @brief Removes the frame with the @a header from the duplicate rejection
+*  table, so that a retransmission of the frame is accepted again
+*  @param[in] header Pointer to the frame header
+*****************************************************************************/
+void nwkRxForgetDuplicate(NwkFrameHeader_t *header)
+{
+	NWK_DuplicateRejectionEntry_t *entry;
+
+	entry = nwkRxDuplicateFind(header->nwkSrcAddr, SYS_TimerTime(), NULL);
+
+	if (entry) {
+		uint8_t diff = (int8_t)entry->seq - header->nwkSeq;
+
+		if (diff < 8) {
+			entry->mask &= ~(1 << diff);
+			entry->ackMask &= ~(1 << diff);
+		}
+	}
+}
+
+/*************************************************************************//**
+*  @brief Records in the duplicate rejection table that the frame with the
+*  @a header was accepted and acknowledged with the current ACK control
+*  value. Only frames acknowledged with the same control value are recorded
+*  at a time, earlier frames with a different value are forgotten.
+*  @param[in] header Pointer to the frame header
+*****************************************************************************/
+static void nwkRxDuplicateAcked(NwkFrameHeader_t *header)
+{
+	NWK_DuplicateRejectionEntry_t *entry;
+
+	entry = nwkRxDuplicateFind(header->nwkSrcAddr, SYS_TimerTime(), NULL);
+
+	if (entry) {
+		uint8_t diff = (int8_t)entry->seq - header->nwkSeq;
+
+		if (diff < 8 && (entry->mask & (1 << diff))) {
+			if (0 == entry->ackMask ||
+					entry->ackControl != nwkRxAckControl) {
+				entry->ackMask = 0;
+				entry->ackControl = nwkRxAckControl;
+			}
+
+			entry->ackMask |= (1 << diff);
+		}
+	}
+}
+
+/*************************************************************************//**
+*  @brief Checks whether the duplicate frame with the @a header was accepted
+*  before and sets the ACK control value to the one its ACK carried
+*  @param[in] header Pointer to the frame header
+*  @return true if the frame was accepted and may be acknowledged again
+*****************************************************************************/
+static bool nwkRxDuplicateAckControl(NwkFrameHeader_t *header)
+{
+	NWK_DuplicateRejectionEntry_t *entry;
+
+	entry = nwkRxDuplicateFind(header->nwkSrcAddr, SYS_TimerTime(), NULL);
+
+	if (entry) {
+		uint8_t diff = (int8_t)entry->seq - header->nwkSeq;
+
+		if (diff < 8 && (entry->ackMask & (1 << diff))) {
+			nwkRxAckControl = entry->ackControl;
+			return true;
+		}
+	}
+
+	return false;
+}
+
 /*************************************************************************//**
 *****************************************************************************/
 static bool nwkRxSeriveDataInd(NWK_DataInd_t *ind)
@@ -285,18 +656,64 @@ static bool nwkRxSeriveDataInd(NWK_DataInd_t *ind)
 		return nwkRouteDiscoveryReplyReceived(ind);
 #endif
 
+#ifdef NWK_ENABLE_FRAGMENTATION
+	case NWK_COMMAND_FRAGMENT:
+		return nwkFragReceived(ind);
+
+	case NWK_COMMAND_FRAGMENT_ACK:
+		return nwkFragAckReceived(ind);
+#endif
+
+#ifdef NWK_ENABLE_STREAM
+	case NWK_COMMAND_STREAM_DATA:
+		return nwkStreamDataReceived(ind);
+
+	case NWK_COMMAND_STREAM_ACK:
+		return nwkStreamAckReceived(ind);
+#endif
+
 	default:
 		return false;
 	}
 }
 
+/*************************************************************************//**
+*  @brief Schedules rebroadcast of the received @a frame
+*  @param[in] frame Pointer to the received frame
+*
+*  The frame buffer is shared between the local delivery and the rebroadcast.
+*  The frame is passed to the Tx module once the Rx module is done with it.
+*  Decryption modifies the frame in place, so frames that have to be decrypted
+*  are rebroadcast from a copy.
+*****************************************************************************/
+static void nwkRxBroadcastFrame(NwkFrame_t *frame)
+{
+#ifdef NWK_ENABLE_SECURITY
+	if (NWK_RX_STATE_DECRYPT == frame->state) {
+		NwkFrame_t *copy;
+
+		if (NULL == (copy = nwkFrameAlloc(NWK_FRAME_CLASS_DATA,
+				frame->size - sizeof(NwkFrameHeader_t)))) {
+			return;
+		}
+
+		copy->size = frame->size;
+		memcpy(copy->data, frame->data, frame->size);
+		nwkTxBroadcastFrame(copy);
+		return;
+	}
+#endif
+
+	frame->rx.rebroadcast = true;
+}
+
 /*************************************************************************//**
 *****************************************************************************/
 static void nwkRxHandleReceivedFrame(NwkFrame_t *frame)
 {
 	NwkFrameHeader_t *header = &frame->header;
 
-	frame->state = NWK_RX_STATE_FINISH;
+	nwkFrameSetState(frame, NWK_RX_STATE_FINISH);
 
 #ifndef NWK_ENABLE_SECURITY
 	if (header->nwkFcf.security) {
@@ -320,10 +737,10 @@ static void nwkRxHandleReceivedFrame(NwkFrame_t *frame)
 				header->nwkDstAddr) {
     #ifdef NWK_ENABLE_SECURITY
 			if (header->nwkFcf.security) {
-				frame->state = NWK_RX_STATE_DECRYPT;
+				nwkFrameSetState(frame, NWK_RX_STATE_DECRYPT);
 			} else
     #endif
-			frame->state = NWK_RX_STATE_INDICATE;
+			nwkFrameSetState(frame, NWK_RX_STATE_INDICATE);
 		}
 
 		return;
@@ -344,11 +761,32 @@ static void nwkRxHandleReceivedFrame(NwkFrame_t *frame)
 		return;
 	}
 
+#ifdef NWK_ENABLE_NEIGHBOUR_TABLE
+	nwkNeighbourFrameReceived(frame);
+#endif
+
 #ifdef NWK_ENABLE_ROUTING
 	nwkRouteFrameReceived(frame);
 #endif
 
 	if (nwkRxRejectDuplicate(header)) {
+		/* The ACK for the original frame may have been lost, so the
+		 * sender retransmits the frame. Frames that are still being
+		 * processed or were rejected are not acknowledged. */
+		if (nwkIb.addr == header->nwkDstAddr &&
+				nwkIb.addr == header->macDstAddr &&
+				header->nwkFcf.ackRequest &&
+				NWK_BROADCAST_ADDR != nwkIb.addr &&
+				nwkRxDuplicateAckControl(header)) {
+			nwkRxSendAck(frame);
+		}
+
+#ifdef NWK_ENABLE_BROADCAST_SUPPRESSION
+		if (NWK_BROADCAST_ADDR == header->macDstAddr) {
+			nwkTxBroadcastOverheard(header);
+		}
+#endif
+
 		return;
 	}
 
@@ -379,49 +817,49 @@ static void nwkRxHandleReceivedFrame(NwkFrame_t *frame)
 
     #ifdef NWK_ENABLE_ROUTING
 			else {
-				frame->state = NWK_RX_STATE_ROUTE;
+				nwkFrameSetState(frame, NWK_RX_STATE_ROUTE);
 			}
     #endif
 		}
 
-		if (broadcast) {
-			nwkTxBroadcastFrame(frame);
-		}
-
 		if (member) {
 			frame->payload += sizeof(NwkFrameMulticastHeader_t);
 
     #ifdef NWK_ENABLE_SECURITY
 			if (header->nwkFcf.security) {
-				frame->state = NWK_RX_STATE_DECRYPT;
+				nwkFrameSetState(frame, NWK_RX_STATE_DECRYPT);
 			} else
     #endif
-			frame->state = NWK_RX_STATE_INDICATE;
+			nwkFrameSetState(frame, NWK_RX_STATE_INDICATE);
+		}
+
+		if (broadcast) {
+			nwkRxBroadcastFrame(frame);
 		}
 	} else
 #endif /* NWK_ENABLE_MULTICAST */
 	{
-		if (NWK_BROADCAST_ADDR == header->macDstAddr && nwkIb.addr !=
-				header->nwkDstAddr &&
-				0 == header->nwkFcf.linkLocal) {
-			nwkTxBroadcastFrame(frame);
-		}
-
 		if (nwkIb.addr == header->nwkDstAddr || NWK_BROADCAST_ADDR ==
 				header->nwkDstAddr) {
     #ifdef NWK_ENABLE_SECURITY
 			if (header->nwkFcf.security) {
-				frame->state = NWK_RX_STATE_DECRYPT;
+				nwkFrameSetState(frame, NWK_RX_STATE_DECRYPT);
 			} else
     #endif
-			frame->state = NWK_RX_STATE_INDICATE;
+			nwkFrameSetState(frame, NWK_RX_STATE_INDICATE);
 		}
 
   #ifdef NWK_ENABLE_ROUTING
 		else if (nwkIb.addr == header->macDstAddr) {
-			frame->state = NWK_RX_STATE_ROUTE;
+			nwkFrameSetState(frame, NWK_RX_STATE_ROUTE);
 		}
   #endif
+
+		if (NWK_BROADCAST_ADDR == header->macDstAddr && nwkIb.addr !=
+				header->nwkDstAddr &&
+				0 == header->nwkFcf.linkLocal) {
+			nwkRxBroadcastFrame(frame);
+		}
 	}
 }
 
@@ -432,10 +870,6 @@ static bool nwkRxIndicateFrame(NwkFrame_t *frame)
 	NwkFrameHeader_t *header = &frame->header;
 	NWK_DataInd_t ind;
 
-	if (NULL == nwkIb.endpoint[header->nwkDstEndpoint]) {
-		return false;
-	}
-
 	ind.srcAddr = header->nwkSrcAddr;
 	ind.dstAddr = header->nwkDstAddr;
 	ind.srcEndpoint = header->nwkSrcEndpoint;
@@ -460,9 +894,68 @@ static bool nwkRxIndicateFrame(NwkFrame_t *frame)
 		|= (NWK_BROADCAST_PANID ==
 			header->macDstPanId) ? NWK_IND_OPT_BROADCAST_PAN_ID : 0;
 
+	if (header->nwkFcf.aggregate) {
+		return nwkRxIndicateAggregate(&ind);
+	}
+
+	if (NULL == nwkIb.endpoint[header->nwkDstEndpoint]) {
+		return false;
+	}
+
 	return nwkIb.endpoint[header->nwkDstEndpoint](&ind);
 }
 
+/*************************************************************************//**
+*  @brief Indicates every payload of the aggregated frame to its endpoint
+*  @param[in] ind Pointer to the indication parameters of the whole frame
+*  @return @c true if the frame is well formed, @c false otherwise
+*
+*  The frame is acknowledged as a whole, so the result does not depend on
+*  what the endpoints return. A payload rejected by its endpoint is lost,
+*  but failing the ACK would make the originator resend the payloads that
+*  were already accepted. Malformed frames are rejected before any payload
+*  is indicated.
+*****************************************************************************/
+static bool nwkRxIndicateAggregate(NWK_DataInd_t *ind)
+{
+	uint8_t *data = ind->data;
+	uint8_t size = ind->size;
+
+	while (size) {
+		NwkFrameAggregateHeader_t *header = (NwkFrameAggregateHeader_t *)data;
+
+		if (size < sizeof(NwkFrameAggregateHeader_t) ||
+				header->size > size - sizeof(NwkFrameAggregateHeader_t) ||
+				NWK_SERVICE_ENDPOINT_ID == header->dstEndpoint) {
+			return false;
+		}
+
+		data += sizeof(NwkFrameAggregateHeader_t) + header->size;
+		size -= sizeof(NwkFrameAggregateHeader_t) + header->size;
+	}
+
+	data = ind->data;
+	size = ind->size;
+
+	while (size) {
+		NwkFrameAggregateHeader_t *header = (NwkFrameAggregateHeader_t *)data;
+
+		ind->srcEndpoint = header->srcEndpoint;
+		ind->dstEndpoint = header->dstEndpoint;
+		ind->data = data + sizeof(NwkFrameAggregateHeader_t);
+		ind->size = header->size;
+
+		if (nwkIb.endpoint[ind->dstEndpoint]) {
+			nwkIb.endpoint[ind->dstEndpoint](ind);
+		}
+
+		data += sizeof(NwkFrameAggregateHeader_t) + header->size;
+		size -= sizeof(NwkFrameAggregateHeader_t) + header->size;
+	}
+
+	return true;
+}
+
 /*************************************************************************//**
 *****************************************************************************/
 static void nwkRxHandleIndication(NwkFrame_t *frame)
@@ -491,10 +984,15 @@ static void nwkRxHandleIndication(NwkFrame_t *frame)
 	}
 
 	if (ack) {
+		nwkRxDuplicateAcked(&frame->header);
 		nwkRxSendAck(frame);
+	} else if (frame->header.nwkFcf.ackRequest &&
+			nwkIb.addr == frame->header.nwkDstAddr) {
+		/* Let a retransmission of the rejected frame through */
+		nwkRxForgetDuplicate(&frame->header);
 	}
 
-	frame->state = NWK_RX_STATE_FINISH;
+	nwkFrameSetState(frame, NWK_RX_STATE_FINISH);
 }
 
 /*************************************************************************//**
@@ -502,43 +1000,39 @@ static void nwkRxHandleIndication(NwkFrame_t *frame)
 *****************************************************************************/
 void nwkRxTaskHandler(void)
 {
-	NwkFrame_t *frame = NULL;
+	NwkFrame_t *frame, *next;
 
-	while (NULL != (frame = nwkFrameNext(frame))) {
-		switch (frame->state) {
-		case NWK_RX_STATE_RECEIVED:
-		{
-			nwkRxHandleReceivedFrame(frame);
-		}
-		break;
+	for (frame = nwkFrameFirst(NWK_RX_STATE_RECEIVED); frame; frame = next) {
+		next = nwkFrameNext(frame);
+		nwkRxHandleReceivedFrame(frame);
+	}
 
 #ifdef NWK_ENABLE_SECURITY
-		case NWK_RX_STATE_DECRYPT:
-		{
-			nwkSecurityProcess(frame, false);
-		}
-		break;
+	for (frame = nwkFrameFirst(NWK_RX_STATE_DECRYPT); frame; frame = next) {
+		next = nwkFrameNext(frame);
+		nwkSecurityProcess(frame, false);
+	}
 #endif
 
-		case NWK_RX_STATE_INDICATE:
-		{
-			nwkRxHandleIndication(frame);
-		}
-		break;
+	for (frame = nwkFrameFirst(NWK_RX_STATE_INDICATE); frame; frame = next) {
+		next = nwkFrameNext(frame);
+		nwkRxHandleIndication(frame);
+	}
 
 #ifdef NWK_ENABLE_ROUTING
-		case NWK_RX_STATE_ROUTE:
-		{
-			nwkRouteFrame(frame);
-		}
-		break;
+	for (frame = nwkFrameFirst(NWK_RX_STATE_ROUTE); frame; frame = next) {
+		next = nwkFrameNext(frame);
+		nwkRouteFrame(frame);
+	}
 #endif
 
-		case NWK_RX_STATE_FINISH:
-		{
+	for (frame = nwkFrameFirst(NWK_RX_STATE_FINISH); frame; frame = next) {
+		next = nwkFrameNext(frame);
+
+		if (frame->rx.rebroadcast) {
+			nwkTxBroadcastFrame(frame);
+		} else {
 			nwkFrameFree(frame);
 		}
-		break;
-		}
 	}
 }
@@ -54,11 +54,11 @@
 
 /*- Types ------------------------------------------------------------------*/
 enum {
-	NWK_SECURITY_STATE_ENCRYPT_PENDING = 0x30,
-	NWK_SECURITY_STATE_DECRYPT_PENDING = 0x31,
-	NWK_SECURITY_STATE_PROCESS         = 0x32,
-	NWK_SECURITY_STATE_WAIT            = 0x33,
-	NWK_SECURITY_STATE_CONFIRM         = 0x34,
+	NWK_SECURITY_STATE_ENCRYPT_PENDING = NWK_FRAME_STATE_SECURITY_BASE,
+	NWK_SECURITY_STATE_DECRYPT_PENDING,
+	NWK_SECURITY_STATE_PROCESS,
+	NWK_SECURITY_STATE_WAIT,
+	NWK_SECURITY_STATE_CONFIRM,
 };
 
 /*- Variables --------------------------------------------------------------*/
@@ -92,9 +92,9 @@ void NWK_SetSecurityKey(uint8_t *key)
 void nwkSecurityProcess(NwkFrame_t *frame, bool encrypt)
 {
 	if (encrypt) {
-		frame->state = NWK_SECURITY_STATE_ENCRYPT_PENDING;
+		nwkFrameSetState(frame, NWK_SECURITY_STATE_ENCRYPT_PENDING);
 	} else {
-		frame->state = NWK_SECURITY_STATE_DECRYPT_PENDING;
+		nwkFrameSetState(frame, NWK_SECURITY_STATE_DECRYPT_PENDING);
 	}
 
 	++nwkSecurityActiveFrames;
@@ -128,7 +128,8 @@ static void nwkSecurityStart(void)
 		= (NWK_SECURITY_STATE_ENCRYPT_PENDING ==
 			nwkSecurityActiveFrame->state);
 
-	nwkSecurityActiveFrame->state = NWK_SECURITY_STATE_PROCESS;
+	nwkFrameSetState(nwkSecurityActiveFrame,
+			NWK_SECURITY_STATE_PROCESS);
 }
 
 /*************************************************************************//**
@@ -158,9 +159,11 @@ void SYS_EncryptConf(void)
 	nwkSecuritySize -= block;
 
 	if (nwkSecuritySize > 0) {
-		nwkSecurityActiveFrame->state = NWK_SECURITY_STATE_PROCESS;
+		nwkFrameSetState(nwkSecurityActiveFrame,
+				NWK_SECURITY_STATE_PROCESS);
 	} else {
-		nwkSecurityActiveFrame->state = NWK_SECURITY_STATE_CONFIRM;
+		nwkFrameSetState(nwkSecurityActiveFrame,
+				NWK_SECURITY_STATE_CONFIRM);
 	}
 }
 
@@ -188,7 +191,7 @@ static bool nwkSecurityProcessMic(void)
 *****************************************************************************/
 void nwkSecurityTaskHandler(void)
 {
-	NwkFrame_t *frame = NULL;
+	NwkFrame_t *frame;
 
 	if (0 == nwkSecurityActiveFrames) {
 		return;
@@ -210,7 +213,8 @@ void nwkSecurityTaskHandler(void)
 			--nwkSecurityActiveFrames;
 		} else if (NWK_SECURITY_STATE_PROCESS ==
 				nwkSecurityActiveFrame->state) {
-			nwkSecurityActiveFrame->state = NWK_SECURITY_STATE_WAIT;
+			nwkFrameSetState(nwkSecurityActiveFrame,
+					NWK_SECURITY_STATE_WAIT);
 			SYS_EncryptReq((uint32_t *)nwkSecurityVector,
 					(uint32_t *)nwkIb.key);
 		}
@@ -218,14 +222,15 @@ void nwkSecurityTaskHandler(void)
 		return;
 	}
 
-	while (NULL != (frame = nwkFrameNext(frame))) {
-		if (NWK_SECURITY_STATE_ENCRYPT_PENDING == frame->state ||
-				NWK_SECURITY_STATE_DECRYPT_PENDING ==
-				frame->state) {
-			nwkSecurityActiveFrame = frame;
-			nwkSecurityStart();
-			return;
-		}
+	frame = nwkFrameFirst(NWK_SECURITY_STATE_DECRYPT_PENDING);
+
+	if (NULL == frame) {
+		frame = nwkFrameFirst(NWK_SECURITY_STATE_ENCRYPT_PENDING);
+	}
+
+	if (frame) {
+		nwkSecurityActiveFrame = frame;
+		nwkSecurityStart();
 	}
 }
 
@@ -0,0 +1,707 @@
+/**
+ * \file nwkStream.c
+ *
+ * \brief Windowed reliable delivery implementation
+ *
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * \asf_license_start
+ *
+ * \page License
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * \asf_license_stop
+ *
+ *
+ */
+
+/*
+ * Copyright (c) 2014-2021 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Licensed under Atmel's Limited License Agreement --> EULA.txt
+ */
+
+/*- Includes ---------------------------------------------------------------*/
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "sysTimer.h"
+#include "sysConfig.h"
+#include "nwk.h"
+#include "nwkTx.h"
+#include "nwkFrame.h"
+#include "nwkCommand.h"
+#include "nwkStream.h"
+
+#ifdef NWK_ENABLE_STREAM
+
+/*- Types ------------------------------------------------------------------*/
+enum {
+	NWK_STREAM_REQ_STATE_SEND,
+	NWK_STREAM_REQ_STATE_WAIT_CONF,
+	NWK_STREAM_REQ_STATE_WAIT_ACK,
+	NWK_STREAM_REQ_STATE_RESEND,
+	NWK_STREAM_REQ_STATE_CONFIRM,
+};
+
+typedef struct NwkStreamTx_t {
+	uint16_t addr;
+	uint8_t seq;
+	uint8_t base;
+	uint8_t attempts;
+	SYS_Timer_t timer;
+} NwkStreamTx_t;
+
+typedef struct NwkStreamRxSlot_t {
+	uint8_t srcEndpoint;
+	uint8_t dstEndpoint;
+	uint8_t options;
+	uint8_t size;
+	uint8_t lqi;
+	int8_t rssi;
+	uint8_t data[NWK_STREAM_MAX_PAYLOAD_SIZE];
+} NwkStreamRxSlot_t;
+
+typedef struct NwkStreamRx_t {
+	uint16_t addr;
+	uint8_t seq;
+	uint8_t received;
+	NwkStreamRxSlot_t slot[NWK_STREAM_WINDOW];
+} NwkStreamRx_t;
+
+/* Fails to compile if NWK_STREAM_HEADER_SIZE does not match the command */
+typedef char nwkStreamHeaderSizeCheck_t[(NWK_STREAM_HEADER_SIZE ==
+		sizeof(NwkCommandStreamData_t)) ? 1 : -1];
+
+/*- Prototypes -------------------------------------------------------------*/
+static NwkStreamTx_t *nwkStreamTxPeer(uint16_t addr, bool allocate);
+static bool nwkStreamPending(NWK_StreamReq_t *req);
+static bool nwkStreamSendFrame(NWK_StreamReq_t *req, NwkStreamTx_t *peer,
+		bool ackRequest);
+static void nwkStreamTxConf(NwkFrame_t *frame);
+static void nwkStreamTxUpdate(NwkStreamTx_t *peer);
+static void nwkStreamAckTimerHandler(SYS_Timer_t *timer);
+static NwkStreamRx_t *nwkStreamRxPeer(uint16_t addr, uint8_t base);
+static void nwkStreamIndicate(NWK_DataInd_t *ind);
+static void nwkStreamRxAdvance(NwkStreamRx_t *peer);
+static void nwkStreamRxSkip(NwkStreamRx_t *peer, uint8_t base);
+static void nwkStreamSendAck(NwkStreamRx_t *peer, bool secured);
+
+/*- Variables --------------------------------------------------------------*/
+static NWK_StreamReq_t *nwkStreamReqQueue;
+static NwkStreamTx_t nwkStreamTx[NWK_STREAM_PEERS_AMOUNT];
+static NwkStreamRx_t nwkStreamRx[NWK_STREAM_PEERS_AMOUNT];
+static uint8_t nwkStreamRxVictim;
+
+/*- Implementations --------------------------------------------------------*/
+
+/*************************************************************************//**
+*  @brief Initializes the Stream module
+*****************************************************************************/
+void nwkStreamInit(void)
+{
+	nwkStreamReqQueue = NULL;
+	nwkStreamRxVictim = 0;
+
+	for (uint8_t i = 0; i < NWK_STREAM_PEERS_AMOUNT; i++) {
+		nwkStreamTx[i].addr = NWK_BROADCAST_ADDR;
+		nwkStreamTx[i].seq = 0;
+		nwkStreamTx[i].base = 0;
+		nwkStreamTx[i].attempts = 0;
+		nwkStreamTx[i].timer.interval = NWK_STREAM_ACK_WAIT_TIME;
+		nwkStreamTx[i].timer.mode = SYS_TIMER_INTERVAL_MODE;
+		nwkStreamTx[i].timer.handler = nwkStreamAckTimerHandler;
+
+		nwkStreamRx[i].addr = NWK_BROADCAST_ADDR;
+		nwkStreamRx[i].received = 0;
+	}
+}
+
+/*************************************************************************//**
+*  @brief Adds request @a req to the queue of outgoing stream requests
+*  @param[in] req Pointer to the request parameters
+*
+*  Up to NWK_STREAM_WINDOW requests per destination are in flight at a time.
+*  The receiver acknowledges all of them with a single cumulative ACK and
+*  a bitmap of the frames received out of order, and passes the payloads to
+*  the destination endpoint in the order of the requests. Requests are
+*  confirmed once acknowledged, so the confirmations may arrive in groups.
+*****************************************************************************/
+void NWK_StreamReq(NWK_StreamReq_t *req)
+{
+	req->state = NWK_STREAM_REQ_STATE_SEND;
+	req->status = NWK_SUCCESS_STATUS;
+	req->frame = NULL;
+	req->next = NULL;
+
+	if (req->size > NWK_STREAM_MAX_PAYLOAD_SIZE ||
+			NWK_BROADCAST_ADDR == req->dstAddr) {
+		req->state = NWK_STREAM_REQ_STATE_CONFIRM;
+		req->status = NWK_ERROR_STATUS;
+	}
+
+	nwkIb.lock++;
+
+	if (NULL == nwkStreamReqQueue) {
+		nwkStreamReqQueue = req;
+	} else {
+		NWK_StreamReq_t *last = nwkStreamReqQueue;
+
+		while (last->next) {
+			last = last->next;
+		}
+
+		last->next = req;
+	}
+}
+
+/*************************************************************************//**
+*  @brief Finds the transmit state of the destination @a addr
+*  @param[in] addr Destination address
+*  @param[in] allocate Take over an idle entry if there is no entry yet
+*  @return Pointer to the entry or @c NULL if there is none
+*
+*  The sequence numbers of the entry are not reset when it is taken over,
+*  the receiver synchronizes to the base number carried in every frame.
+*****************************************************************************/
+static NwkStreamTx_t *nwkStreamTxPeer(uint16_t addr, bool allocate)
+{
+	NwkStreamTx_t *idle = NULL;
+
+	for (uint8_t i = 0; i < NWK_STREAM_PEERS_AMOUNT; i++) {
+		if (addr == nwkStreamTx[i].addr) {
+			return &nwkStreamTx[i];
+		}
+
+		if (NULL == idle && nwkStreamTx[i].seq == nwkStreamTx[i].base) {
+			idle = &nwkStreamTx[i];
+		}
+	}
+
+	if (allocate && idle) {
+		idle->addr = addr;
+		idle->attempts = 0;
+		return idle;
+	}
+
+	return NULL;
+}
+
+/*************************************************************************//**
+*  @brief Checks if there are more requests waiting for the destination of
+*  the request @a req
+*****************************************************************************/
+static bool nwkStreamPending(NWK_StreamReq_t *req)
+{
+	for (NWK_StreamReq_t *next = req->next; next; next = next->next) {
+		if (NWK_STREAM_REQ_STATE_SEND == next->state &&
+				next->dstAddr == req->dstAddr) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static bool nwkStreamSendFrame(NWK_StreamReq_t *req, NwkStreamTx_t *peer,
+		bool ackRequest)
+{
+	NwkFrame_t *frame;
+	NwkCommandStreamData_t *command;
+
+	if (NULL == (frame = nwkFrameAlloc(NWK_FRAME_CLASS_DATA,
+			sizeof(NwkCommandStreamData_t) + req->size))) {
+		return false;
+	}
+
+	frame->tx.confirm = nwkStreamTxConf;
+	frame->tx.control = req->options & NWK_OPT_RETRY ?
+			NWK_TX_CONTROL_RETRY : 0;
+	frame->tx.priority = NWK_PRIORITY_NORMAL;
+
+#ifdef NWK_ENABLE_SECURE_COMMANDS
+	frame->header.nwkFcf.security = 1;
+#elif defined(NWK_ENABLE_SECURITY)
+	frame->header.nwkFcf.security = req->options &
+			NWK_OPT_ENABLE_SECURITY ? 1 : 0;
+#endif
+
+	frame->header.nwkSeq = ++nwkIb.nwkSeqNum;
+	frame->header.nwkSrcAddr = nwkIb.addr;
+	frame->header.nwkDstAddr = req->dstAddr;
+
+	command = (NwkCommandStreamData_t *)frame->payload;
+	command->id = NWK_COMMAND_STREAM_DATA;
+	command->seq = req->seq;
+	command->base = peer->base;
+	command->control = ackRequest ? NWK_COMMAND_STREAM_ACK_REQUEST : 0;
+	command->srcEndpoint = req->srcEndpoint;
+	command->dstEndpoint = req->dstEndpoint;
+
+	memcpy(frame->payload + sizeof(NwkCommandStreamData_t), req->data,
+			req->size);
+	frame->size += sizeof(NwkCommandStreamData_t) + req->size;
+
+	req->frame = frame;
+	req->state = NWK_STREAM_REQ_STATE_WAIT_CONF;
+	nwkTxFrame(frame);
+
+	if (!SYS_TimerStarted(&peer->timer)) {
+		SYS_TimerStart(&peer->timer);
+	}
+
+	return true;
+}
+
+/*************************************************************************//**
+*  @brief Stream frame transmission confirmation handler
+*  @param[in] frame Pointer to the sent frame
+*
+*  Transmission failures are not handled here, the frames that did not make
+*  it are sent again once the receiver reports them missing or the ACK wait
+*  timer expires.
+*****************************************************************************/
+static void nwkStreamTxConf(NwkFrame_t *frame)
+{
+	for (NWK_StreamReq_t *req = nwkStreamReqQueue; req; req = req->next) {
+		if (req->frame == frame) {
+			req->frame = NULL;
+
+			if (NWK_STREAM_REQ_STATE_WAIT_CONF == req->state) {
+				req->state = NWK_STREAM_REQ_STATE_WAIT_ACK;
+			}
+
+			break;
+		}
+	}
+
+	nwkFrameFree(frame);
+}
+
+/*************************************************************************//**
+*  @brief Recalculates the oldest unacknowledged sequence number of the
+*  destination @a peer and restarts its ACK wait timer
+*****************************************************************************/
+static void nwkStreamTxUpdate(NwkStreamTx_t *peer)
+{
+	uint8_t base = peer->seq;
+
+	for (NWK_StreamReq_t *req = nwkStreamReqQueue; req; req = req->next) {
+		if (req->dstAddr != peer->addr ||
+				NWK_STREAM_REQ_STATE_SEND == req->state ||
+				NWK_STREAM_REQ_STATE_CONFIRM == req->state) {
+			continue;
+		}
+
+		if ((uint8_t)(req->seq - peer->base) <
+				(uint8_t)(base - peer->base)) {
+			base = req->seq;
+		}
+	}
+
+	peer->base = base;
+
+	SYS_TimerStop(&peer->timer);
+
+	if (peer->seq != peer->base) {
+		SYS_TimerStart(&peer->timer);
+	}
+}
+
+/*************************************************************************//**
+*  @brief Processes the stream acknowledgement from the receiver
+*  @param[in] ind Pointer to the indication parameters of the command
+*  @return @c true if the command is valid, @c false otherwise
+*
+*  Frames before the cumulative sequence number and the frames marked in the
+*  bitmap are confirmed. Frames preceding a marked one are considered lost
+*  and are sent again without waiting for the ACK wait timer.
+*****************************************************************************/
+bool nwkStreamAckReceived(NWK_DataInd_t *ind)
+{
+	NwkCommandStreamAck_t *command = (NwkCommandStreamAck_t *)ind->data;
+	NwkStreamTx_t *peer;
+	uint8_t acked;
+	bool progress = false;
+
+	if (sizeof(NwkCommandStreamAck_t) != ind->size) {
+		return false;
+	}
+
+	peer = nwkStreamTxPeer(ind->srcAddr, false);
+
+	if (NULL == peer || peer->seq == peer->base) {
+		return true;
+	}
+
+	acked = command->seq - peer->base;
+
+	if (acked > (uint8_t)(peer->seq - peer->base)) {
+		return true;
+	}
+
+	for (NWK_StreamReq_t *req = nwkStreamReqQueue; req; req = req->next) {
+		uint8_t bit = req->seq - command->seq - 1;
+		uint8_t later;
+
+		if (req->dstAddr != peer->addr ||
+				NWK_STREAM_REQ_STATE_SEND == req->state ||
+				NWK_STREAM_REQ_STATE_CONFIRM == req->state) {
+			continue;
+		}
+
+		if ((uint8_t)(req->seq - peer->base) < acked ||
+				(bit < 8 && (command->bitmap & (1 << bit)))) {
+			req->state = NWK_STREAM_REQ_STATE_CONFIRM;
+			progress = true;
+			continue;
+		}
+
+		if (0xff == bit) {
+			later = command->bitmap;
+		} else {
+			later = (bit < 7) ? (command->bitmap >> (bit + 1)) : 0;
+		}
+
+		if (later && NWK_STREAM_REQ_STATE_WAIT_ACK == req->state) {
+			req->state = NWK_STREAM_REQ_STATE_RESEND;
+		}
+	}
+
+	if (progress) {
+		peer->attempts = 0;
+		nwkStreamTxUpdate(peer);
+	}
+
+	return true;
+}
+
+/*************************************************************************//**
+*  @brief Stream ACK wait timer handler
+*  @param[in] timer Pointer to the timer
+*
+*  All unacknowledged frames of the destination are sent again. After
+*  NWK_STREAM_RETRY_AMOUNT attempts without progress they are confirmed with
+*  NWK_NO_ACK_STATUS and the receiver is told to skip them.
+*****************************************************************************/
+static void nwkStreamAckTimerHandler(SYS_Timer_t *timer)
+{
+	NwkStreamTx_t *peer = NULL;
+	bool fail;
+
+	for (uint8_t i = 0; i < NWK_STREAM_PEERS_AMOUNT; i++) {
+		if (timer == &nwkStreamTx[i].timer) {
+			peer = &nwkStreamTx[i];
+		}
+	}
+
+	fail = (++peer->attempts > NWK_STREAM_RETRY_AMOUNT);
+
+	for (NWK_StreamReq_t *req = nwkStreamReqQueue; req; req = req->next) {
+		if (req->dstAddr != peer->addr ||
+				NWK_STREAM_REQ_STATE_SEND == req->state ||
+				NWK_STREAM_REQ_STATE_CONFIRM == req->state) {
+			continue;
+		}
+
+		if (fail) {
+			req->status = NWK_NO_ACK_STATUS;
+			req->state = NWK_STREAM_REQ_STATE_CONFIRM;
+		} else if (NWK_STREAM_REQ_STATE_WAIT_ACK == req->state) {
+			req->state = NWK_STREAM_REQ_STATE_RESEND;
+		}
+	}
+
+	if (fail) {
+		peer->attempts = 0;
+	}
+
+	nwkStreamTxUpdate(peer);
+}
+
+/*************************************************************************//**
+*  @brief Finds the receive state of the source @a addr
+*  @param[in] addr Source address
+*  @param[in] base Oldest unacknowledged sequence number of the source
+*  @return Pointer to the entry or @c NULL if all entries hold out of order
+*  frames of other sources
+*
+*  An entry taken over from another source loses its sequence number, so
+*  that source may see its unacknowledged frames indicated twice. The table
+*  should have an entry for every node sending streams to this node.
+*****************************************************************************/
+static NwkStreamRx_t *nwkStreamRxPeer(uint16_t addr, uint8_t base)
+{
+	NwkStreamRx_t *peer = NULL;
+
+	for (uint8_t i = 0; i < NWK_STREAM_PEERS_AMOUNT; i++) {
+		if (addr == nwkStreamRx[i].addr) {
+			return &nwkStreamRx[i];
+		}
+	}
+
+	for (uint8_t i = 0; i < NWK_STREAM_PEERS_AMOUNT; i++) {
+		uint8_t index = (nwkStreamRxVictim + i) % NWK_STREAM_PEERS_AMOUNT;
+
+		if (0 == nwkStreamRx[index].received) {
+			peer = &nwkStreamRx[index];
+			nwkStreamRxVictim = (index + 1) % NWK_STREAM_PEERS_AMOUNT;
+			break;
+		}
+	}
+
+	if (peer) {
+		peer->addr = addr;
+		peer->seq = base;
+	}
+
+	return peer;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static void nwkStreamIndicate(NWK_DataInd_t *ind)
+{
+	if (NWK_SERVICE_ENDPOINT_ID == ind->dstEndpoint ||
+			NULL == nwkIb.endpoint[ind->dstEndpoint]) {
+		return;
+	}
+
+	nwkIb.endpoint[ind->dstEndpoint](ind);
+}
+
+/*************************************************************************//**
+*  @brief Moves the expected sequence number of the @a peer past the current
+*  frame and indicates the frames that were received out of order
+*****************************************************************************/
+static void nwkStreamRxAdvance(NwkStreamRx_t *peer)
+{
+	peer->seq++;
+
+	while (peer->received & 1) {
+		NwkStreamRxSlot_t *slot = &peer->slot[peer->seq % NWK_STREAM_WINDOW];
+		NWK_DataInd_t ind;
+
+		ind.srcAddr = peer->addr;
+		ind.dstAddr = nwkIb.addr;
+		ind.srcEndpoint = slot->srcEndpoint;
+		ind.dstEndpoint = slot->dstEndpoint;
+		ind.options = slot->options;
+		ind.data = slot->data;
+		ind.size = slot->size;
+		ind.lqi = slot->lqi;
+		ind.rssi = slot->rssi;
+
+		peer->received >>= 1;
+		peer->seq++;
+
+		nwkStreamIndicate(&ind);
+	}
+
+	peer->received >>= 1;
+}
+
+/*************************************************************************//**
+*  @brief Skips the frames the source gave up on
+*  @param[in] peer Pointer to the receive state of the source
+*  @param[in] base Oldest unacknowledged sequence number of the source
+*
+*  The frames received out of order before @a base are still indicated.
+*  If @a base is not within the window, the source has restarted its
+*  sequence numbers and all buffered frames are indicated.
+*****************************************************************************/
+static void nwkStreamRxSkip(NwkStreamRx_t *peer, uint8_t base)
+{
+	if ((uint8_t)(base - peer->seq) > NWK_STREAM_WINDOW) {
+		while (peer->received) {
+			nwkStreamRxAdvance(peer);
+		}
+
+		peer->seq = base;
+		return;
+	}
+
+	while (peer->seq != base &&
+			(uint8_t)(base - peer->seq) <= NWK_STREAM_WINDOW) {
+		nwkStreamRxAdvance(peer);
+	}
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static void nwkStreamSendAck(NwkStreamRx_t *peer, bool secured)
+{
+	NwkFrame_t *frame;
+	NwkCommandStreamAck_t *command;
+
+	if (NULL == (frame = nwkFrameAlloc(NWK_FRAME_CLASS_COMMAND,
+			sizeof(NwkCommandStreamAck_t)))) {
+		return;
+	}
+
+	nwkFrameCommandInit(frame);
+
+	frame->size += sizeof(NwkCommandStreamAck_t);
+	frame->tx.confirm = NULL;
+
+	frame->header.nwkFcf.security = secured ? 1 : 0;
+	frame->header.nwkDstAddr = peer->addr;
+
+	command = (NwkCommandStreamAck_t *)frame->payload;
+	command->id = NWK_COMMAND_STREAM_ACK;
+	command->seq = peer->seq;
+	command->bitmap = peer->received;
+
+	nwkTxFrame(frame);
+}
+
+/*************************************************************************//**
+*  @brief Processes the received stream frame
+*  @param[in] ind Pointer to the indication parameters of the command
+*  @return @c true if the command is valid, @c false otherwise
+*
+*  The expected frame is indicated right away, frames received out of order
+*  are buffered until the missing ones arrive. An ACK is sent when the
+*  source requests one or a duplicate frame shows that the previous ACK was
+*  lost.
+*****************************************************************************/
+bool nwkStreamDataReceived(NWK_DataInd_t *ind)
+{
+	NwkCommandStreamData_t *command = (NwkCommandStreamData_t *)ind->data;
+	bool secured = (ind->options & NWK_IND_OPT_SECURED) ? true : false;
+	NwkStreamRx_t *peer;
+	uint8_t offset;
+	bool ack;
+
+	if (ind->size < sizeof(NwkCommandStreamData_t) ||
+			ind->size > (sizeof(NwkCommandStreamData_t) +
+			NWK_STREAM_MAX_PAYLOAD_SIZE) ||
+			NWK_BROADCAST_ADDR == ind->dstAddr) {
+		return false;
+	}
+
+	ack = (command->control & NWK_COMMAND_STREAM_ACK_REQUEST) ? true : false;
+
+	if (NULL == (peer = nwkStreamRxPeer(ind->srcAddr, command->base))) {
+		return true;
+	}
+
+	if ((uint8_t)(peer->seq - command->base) > NWK_STREAM_WINDOW) {
+		nwkStreamRxSkip(peer, command->base);
+	}
+
+	offset = command->seq - peer->seq;
+
+	if (0 == offset) {
+		ind->srcEndpoint = command->srcEndpoint;
+		ind->dstEndpoint = command->dstEndpoint;
+		ind->options &= ~NWK_IND_OPT_ACK_REQUESTED;
+		ind->data += sizeof(NwkCommandStreamData_t);
+		ind->size -= sizeof(NwkCommandStreamData_t);
+
+		nwkStreamIndicate(ind);
+		nwkStreamRxAdvance(peer);
+	} else if (offset < NWK_STREAM_WINDOW) {
+		uint8_t bit = 1 << (offset - 1);
+
+		if (0 == (peer->received & bit)) {
+			NwkStreamRxSlot_t *slot =
+					&peer->slot[command->seq % NWK_STREAM_WINDOW];
+
+			slot->srcEndpoint = command->srcEndpoint;
+			slot->dstEndpoint = command->dstEndpoint;
+			slot->options = ind->options & ~NWK_IND_OPT_ACK_REQUESTED;
+			slot->size = ind->size - sizeof(NwkCommandStreamData_t);
+			slot->lqi = ind->lqi;
+			slot->rssi = ind->rssi;
+			memcpy(slot->data, ind->data + sizeof(NwkCommandStreamData_t),
+					slot->size);
+
+			peer->received |= bit;
+		}
+	} else if (offset < 0x80) {
+		return true;
+	} else {
+		ack = true;
+	}
+
+	if (ack) {
+		nwkStreamSendAck(peer, secured);
+	}
+
+	return true;
+}
+
+/*************************************************************************//**
+*  @brief Stream module task handler
+*****************************************************************************/
+void nwkStreamTaskHandler(void)
+{
+	NWK_StreamReq_t *prev = NULL;
+	NWK_StreamReq_t *next;
+
+	for (NWK_StreamReq_t *req = nwkStreamReqQueue; req; req = next) {
+		NwkStreamTx_t *peer;
+
+		next = req->next;
+
+		if (NWK_STREAM_REQ_STATE_SEND == req->state) {
+			peer = nwkStreamTxPeer(req->dstAddr, true);
+
+			if (peer && (uint8_t)(peer->seq - peer->base) <
+					NWK_STREAM_WINDOW) {
+				bool last = (uint8_t)(peer->seq + 1 - peer->base) ==
+						NWK_STREAM_WINDOW || !nwkStreamPending(req);
+
+				req->seq = peer->seq;
+
+				if (!nwkStreamSendFrame(req, peer, last)) {
+					break;
+				}
+
+				peer->seq++;
+			}
+		} else if (NWK_STREAM_REQ_STATE_RESEND == req->state) {
+			peer = nwkStreamTxPeer(req->dstAddr, false);
+
+			if (!nwkStreamSendFrame(req, peer, true)) {
+				break;
+			}
+		} else if (NWK_STREAM_REQ_STATE_CONFIRM == req->state &&
+				NULL == req->frame) {
+			if (prev) {
+				prev->next = next;
+			} else {
+				nwkStreamReqQueue = next;
+			}
+
+			nwkIb.lock--;
+			req->confirm(req);
+			continue;
+		}
+
+		prev = req;
+	}
+}
+
+#endif /* NWK_ENABLE_STREAM */
@@ -40,6 +40,7 @@
 
 /*- Includes ---------------------------------------------------------------*/
 #include <stdlib.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
@@ -50,34 +51,75 @@
 #include "nwkTx.h"
 #include "nwkFrame.h"
 #include "nwkRoute.h"
+#include "nwkNeighbour.h"
 #include "nwkCommand.h"
 #include "nwkSecurity.h"
 
 /*- Definitions ------------------------------------------------------------*/
-#define NWK_TX_ACK_WAIT_TIMER_INTERVAL    50 /* ms */
-#define NWK_TX_DELAY_TIMER_INTERVAL       10 /* ms */
+#define NWK_TX_DELAY_JITTER_STEP          10 /* ms */
 #define NWK_TX_DELAY_JITTER_MASK          0x07
+#define NWK_TX_BROADCAST_MAX_SLOTS        64
+
+#if defined(NWK_ENABLE_PHY_TX_QUEUE) && defined(PHY_HAS_TX_QUEUE)
+  #define NWK_TX_PHY_FRAMES               2
+#else
+  #define NWK_TX_PHY_FRAMES               1
+#endif
 
 /*- Types ------------------------------------------------------------------*/
 enum {
-	NWK_TX_STATE_ENCRYPT    = 0x10,
-	NWK_TX_STATE_WAIT_DELAY = 0x11,
-	NWK_TX_STATE_DELAY      = 0x12,
-	NWK_TX_STATE_SEND       = 0x13,
-	NWK_TX_STATE_WAIT_CONF  = 0x14,
-	NWK_TX_STATE_SENT       = 0x15,
-	NWK_TX_STATE_WAIT_ACK   = 0x16,
-	NWK_TX_STATE_CONFIRM    = 0x17,
+	NWK_TX_STATE_ENCRYPT    = NWK_FRAME_STATE_TX_BASE,
+	NWK_TX_STATE_WAIT_DELAY,
+	NWK_TX_STATE_DELAY,
+	NWK_TX_STATE_SEND, /* One queue for each priority class */
+	NWK_TX_STATE_SEND_LAST  = NWK_TX_STATE_SEND + NWK_PRIORITIES_AMOUNT - 1,
+	NWK_TX_STATE_WAIT_CONF,
+	NWK_TX_STATE_SENT,
+	NWK_TX_STATE_WAIT_ACK,
+	NWK_TX_STATE_CONFIRM,
 };
 
 /*- Prototypes -------------------------------------------------------------*/
 static void nwkTxAckWaitTimerHandler(SYS_Timer_t *timer);
 static void nwkTxDelayTimerHandler(SYS_Timer_t *timer);
+static void nwkTxDeadlineStart(NwkFrame_t *frame, uint8_t state,
+		SYS_Timer_t *timer, uint16_t timeout);
+static void nwkTxDeadlineStop(NwkFrame_t *frame, SYS_Timer_t *timer);
+static void nwkTxDeadlineRestart(uint8_t state, SYS_Timer_t *timer);
+static bool nwkTxRetryFrame(NwkFrame_t *frame);
+static NwkFrame_t *nwkTxNextFrame(void);
+#ifdef NWK_ENABLE_HEADER_COMPRESSION
+static uint8_t *nwkTxCompressHeader(NwkFrame_t *frame);
+static void nwkTxRestoreHeader(NwkFrame_t *frame);
+#endif
+#ifdef NWK_ENABLE_BROADCAST_SUPPRESSION
+static NwkFrame_t *nwkTxFindRebroadcast(uint8_t state,
+		NwkFrameHeader_t *header);
+static void nwkTxUpdateDensity(uint8_t copies);
+#endif
+#if defined(NWK_ENABLE_ADAPTIVE_ACK_WAIT) || \
+	defined(NWK_ENABLE_NEIGHBOUR_TABLE)
+static uint16_t nwkTxDeadlineRemaining(NwkFrame_t *frame,
+		SYS_Timer_t *timer);
+#endif
+#ifdef NWK_ENABLE_ADAPTIVE_ACK_WAIT
+static NWK_RttTableEntry_t *nwkTxRttFind(uint16_t dst);
+static void nwkTxRttUpdate(uint16_t dst, uint16_t rtt);
+static void nwkTxRttRemove(uint16_t dst);
+#endif
 
 /*- Variables --------------------------------------------------------------*/
-static NwkFrame_t *nwkTxPhyActiveFrame;
+static uint8_t nwkTxPhyFrames;
+static uint8_t nwkTxPriorityCredit;
 static SYS_Timer_t nwkTxAckWaitTimer;
 static SYS_Timer_t nwkTxDelayTimer;
+#ifdef NWK_ENABLE_BROADCAST_SUPPRESSION
+static uint8_t nwkTxBroadcastDensity; /* Copies heard per flood x 16 */
+#endif
+#ifdef NWK_ENABLE_ADAPTIVE_ACK_WAIT
+static NWK_RttTableEntry_t nwkTxRttTable[NWK_RTT_TABLE_SIZE];
+static uint8_t nwkTxRttReplace;
+#endif
 
 /*- Implementations --------------------------------------------------------*/
 
@@ -86,13 +128,24 @@ static SYS_Timer_t nwkTxDelayTimer;
 *****************************************************************************/
 void nwkTxInit(void)
 {
-	nwkTxPhyActiveFrame = NULL;
+	nwkTxPhyFrames = 0;
+	nwkTxPriorityCredit = NWK_PRIORITY_WEIGHT;
+
+#ifdef NWK_ENABLE_BROADCAST_SUPPRESSION
+	nwkTxBroadcastDensity = 0;
+#endif
+
+#ifdef NWK_ENABLE_ADAPTIVE_ACK_WAIT
+	for (uint8_t i = 0; i < NWK_RTT_TABLE_SIZE; i++) {
+		nwkTxRttTable[i].dstAddr = NWK_BROADCAST_ADDR;
+	}
+
+	nwkTxRttReplace = 0;
+#endif
 
-	nwkTxAckWaitTimer.interval = NWK_TX_ACK_WAIT_TIMER_INTERVAL;
 	nwkTxAckWaitTimer.mode = SYS_TIMER_INTERVAL_MODE;
 	nwkTxAckWaitTimer.handler = nwkTxAckWaitTimerHandler;
 
-	nwkTxDelayTimer.interval = NWK_TX_DELAY_TIMER_INTERVAL;
 	nwkTxDelayTimer.mode = SYS_TIMER_INTERVAL_MODE;
 	nwkTxDelayTimer.handler = nwkTxDelayTimerHandler;
 }
@@ -104,17 +157,18 @@ void nwkTxFrame(NwkFrame_t *frame)
 	NwkFrameHeader_t *header = &frame->header;
 
 	if (frame->tx.control & NWK_TX_CONTROL_ROUTING) {
-		frame->state = NWK_TX_STATE_DELAY;
+		nwkFrameSetState(frame, NWK_TX_STATE_DELAY);
 	} else {
   #ifdef NWK_ENABLE_SECURITY
 		if (header->nwkFcf.security) {
-			frame->state = NWK_TX_STATE_ENCRYPT;
+			nwkFrameSetState(frame, NWK_TX_STATE_ENCRYPT);
 		} else
   #endif
-		frame->state = NWK_TX_STATE_DELAY;
+		nwkFrameSetState(frame, NWK_TX_STATE_DELAY);
 	}
 
 	frame->tx.status = NWK_SUCCESS_STATUS;
+	frame->tx.attempts = 0;
 
 	if (frame->tx.control & NWK_TX_CONTROL_BROADCAST_PAN_ID) {
 		header->macDstPanId = NWK_BROADCAST_PANID;
@@ -136,7 +190,8 @@ void nwkTxFrame(NwkFrame_t *frame)
 
 	if (NWK_BROADCAST_ADDR == header->macDstAddr) {
 		header->macFcf = 0x8841;
-		frame->tx.timeout = (rand() & NWK_TX_DELAY_JITTER_MASK) + 1;
+		frame->tx.timeout = ((rand() & NWK_TX_DELAY_JITTER_MASK) + 1) *
+				NWK_TX_DELAY_JITTER_STEP;
 	} else {
 		header->macFcf = 0x8861;
 		frame->tx.timeout = 0;
@@ -144,79 +199,208 @@ void nwkTxFrame(NwkFrame_t *frame)
 }
 
 /*************************************************************************//**
+*  @brief Rebroadcasts a received @a frame from its own buffer
+*  @param[in] frame Pointer to the received frame
+*
+*  Only the MAC header is updated, the rest of the frame is sent as received.
+*  With the broadcast suppression enabled the delay window grows with the
+*  estimated neighbourhood density.
 *****************************************************************************/
 void nwkTxBroadcastFrame(NwkFrame_t *frame)
 {
-	NwkFrame_t *newFrame;
+#ifdef NWK_ENABLE_BROADCAST_SUPPRESSION
+	uint16_t slots = (NWK_TX_DELAY_JITTER_MASK + 1) *
+			(1 + nwkTxBroadcastDensity / 16);
+
+	if (slots > NWK_TX_BROADCAST_MAX_SLOTS) {
+		slots = NWK_TX_BROADCAST_MAX_SLOTS;
+	}
+
+	frame->tx.timeout = (rand() % slots + 1) * NWK_TX_DELAY_JITTER_STEP;
+	frame->tx.copies = 0;
+#else
+	frame->tx.timeout = ((rand() & NWK_TX_DELAY_JITTER_MASK) + 1) *
+			NWK_TX_DELAY_JITTER_STEP;
+#endif
+
+	nwkFrameSetState(frame, NWK_TX_STATE_DELAY);
+	frame->tx.status = NWK_SUCCESS_STATUS;
+	frame->tx.control = NWK_TX_CONTROL_REBROADCAST;
+	frame->tx.priority = NWK_PRIORITY_NORMAL;
+	frame->tx.attempts = 0;
+	frame->tx.confirm = NULL;
+
+	frame->header.macFcf = 0x8841;
+	frame->header.macDstAddr = NWK_BROADCAST_ADDR;
+	frame->header.macSrcAddr = nwkIb.addr;
+	frame->header.macSeq = ++nwkIb.macSeqNum;
+}
+
+#ifdef NWK_ENABLE_BROADCAST_SUPPRESSION
+
+/*************************************************************************//**
+*  @brief Counts an overheard copy of a frame waiting to be rebroadcast
+*  @param[in] header Pointer to the header of the received copy
+*
+*  The rebroadcast is cancelled once NWK_BROADCAST_SUPPRESSION_THRESHOLD
+*  copies were heard during its delay, since the neighbours have most likely
+*  received the frame already. The average number of copies heard per flood
+*  is used as an estimate of the neighbourhood density.
+*****************************************************************************/
+void nwkTxBroadcastOverheard(NwkFrameHeader_t *header)
+{
+	NwkFrame_t *frame;
 
-	if (NULL == (newFrame = nwkFrameAlloc())) {
+	frame = nwkTxFindRebroadcast(NWK_TX_STATE_WAIT_DELAY, header);
+
+	if (NULL == frame) {
+		frame = nwkTxFindRebroadcast(NWK_TX_STATE_DELAY, header);
+	}
+
+	if (NULL == frame) {
+		return;
+	}
+
+	if (++frame->tx.copies < NWK_BROADCAST_SUPPRESSION_THRESHOLD) {
 		return;
 	}
 
-	newFrame->state = NWK_TX_STATE_DELAY;
-	newFrame->size = frame->size;
-	newFrame->tx.status = NWK_SUCCESS_STATUS;
-	newFrame->tx.timeout = (rand() & NWK_TX_DELAY_JITTER_MASK) + 1;
-	newFrame->tx.confirm = NULL;
-	memcpy(newFrame->data, frame->data, frame->size);
+	if (NWK_TX_STATE_WAIT_DELAY == frame->state) {
+		nwkTxDeadlineStop(frame, &nwkTxDelayTimer);
+	}
+
+	nwkTxUpdateDensity(frame->tx.copies);
+	nwkFrameFree(frame);
+}
 
-	newFrame->header.macFcf = 0x8841;
-	newFrame->header.macDstAddr = NWK_BROADCAST_ADDR;
-	newFrame->header.macDstPanId = frame->header.macDstPanId;
-	newFrame->header.macSrcAddr = nwkIb.addr;
-	newFrame->header.macSeq = ++nwkIb.macSeqNum;
+/*************************************************************************//**
+*****************************************************************************/
+static NwkFrame_t *nwkTxFindRebroadcast(uint8_t state,
+		NwkFrameHeader_t *header)
+{
+	for (NwkFrame_t *frame = nwkFrameFirst(state); frame;
+			frame = nwkFrameNext(frame)) {
+		if ((frame->tx.control & NWK_TX_CONTROL_REBROADCAST) &&
+				header->nwkSrcAddr == frame->header.nwkSrcAddr &&
+				header->nwkSeq == frame->header.nwkSeq) {
+			return frame;
+		}
+	}
+
+	return NULL;
 }
 
 /*************************************************************************//**
 *****************************************************************************/
+static void nwkTxUpdateDensity(uint8_t copies)
+{
+	int16_t density = nwkTxBroadcastDensity;
+
+	density += ((int16_t)copies * 16 - density) / 8;
+	nwkTxBroadcastDensity = density;
+}
+
+#endif /* NWK_ENABLE_BROADCAST_SUPPRESSION */
+
+/*************************************************************************//**
+*  @brief Confirms the frames acknowledged by the received ACK command
+*  @param[in] ind Pointer to the indication parameters of the command
+*  @return @c true if at least one frame was acknowledged, @c false otherwise
+*
+*  A delayed ACK lists the sequence numbers of more frames after the control
+*  field, all of them are confirmed with the same control value.
+*****************************************************************************/
 bool nwkTxAckReceived(NWK_DataInd_t *ind)
 {
 	NwkCommandAck_t *command = (NwkCommandAck_t *)ind->data;
-	NwkFrame_t *frame = NULL;
+	NwkFrame_t *frame, *next;
+	bool found = false;
 
-	if (sizeof(NwkCommandAck_t) != ind->size) {
+	if (ind->size < sizeof(NwkCommandAck_t)) {
 		return false;
 	}
 
-	while (NULL != (frame = nwkFrameNext(frame))) {
-		if (NWK_TX_STATE_WAIT_ACK == frame->state &&
-				frame->header.nwkSeq == command->seq) {
-			frame->state = NWK_TX_STATE_CONFIRM;
-			frame->tx.control = command->control;
-			return true;
+	for (frame = nwkFrameFirst(NWK_TX_STATE_WAIT_ACK); frame;
+			frame = next) {
+		bool acked = (frame->header.nwkSeq == command->seq);
+
+		next = nwkFrameNext(frame);
+
+		/* Sequence numbers are only unique per originator, so ACKs from
+		 * one destination must not confirm frames sent to another */
+		if (frame->header.nwkDstAddr != ind->srcAddr) {
+			continue;
+		}
+
+		for (uint8_t i = sizeof(NwkCommandAck_t); i < ind->size; i++) {
+			if (frame->header.nwkSeq == ind->data[i]) {
+				acked = true;
+			}
 		}
+
+		if (!acked) {
+			continue;
+		}
+
+#if defined(NWK_ENABLE_ADAPTIVE_ACK_WAIT) || \
+		defined(NWK_ENABLE_NEIGHBOUR_TABLE)
+		/* ACKs for retransmitted frames are ambiguous */
+		if (1 == frame->tx.attempts) {
+  #ifdef NWK_ENABLE_ADAPTIVE_ACK_WAIT
+			uint16_t rtt = frame->tx.ackWait;
+  #else
+			uint16_t rtt = NWK_ACK_WAIT_TIME;
+  #endif
+
+			rtt -= nwkTxDeadlineRemaining(frame, &nwkTxAckWaitTimer);
+
+  #ifdef NWK_ENABLE_ADAPTIVE_ACK_WAIT
+			nwkTxRttUpdate(frame->header.nwkDstAddr, rtt);
+  #endif
+  #ifdef NWK_ENABLE_NEIGHBOUR_TABLE
+			if (frame->header.macDstAddr == frame->header.nwkDstAddr) {
+				nwkNeighbourAckReceived(frame->header.nwkDstAddr,
+						rtt);
+			}
+  #endif
+		}
+#endif
+		nwkTxDeadlineStop(frame, &nwkTxAckWaitTimer);
+		frame->tx.control = command->control;
+		nwkFrameSetState(frame, NWK_TX_STATE_CONFIRM);
+		found = true;
 	}
 
-	return false;
+	return found;
 }
 
 /*************************************************************************//**
 *****************************************************************************/
 static void nwkTxAckWaitTimerHandler(SYS_Timer_t *timer)
 {
-	NwkFrame_t *frame = NULL;
-	bool restart = false;
+	NwkFrame_t *frame, *next;
 
-	while (NULL != (frame = nwkFrameNext(frame))) {
-		if (NWK_TX_STATE_WAIT_ACK == frame->state) {
-			restart = true;
+	for (frame = nwkFrameFirst(NWK_TX_STATE_WAIT_ACK); frame;
+			frame = next) {
+		next = nwkFrameNext(frame);
+#ifdef NWK_ENABLE_ADAPTIVE_ACK_WAIT
+		nwkTxRttRemove(frame->header.nwkDstAddr);
+#endif
+		nwkTxConfirm(frame, NWK_NO_ACK_STATUS);
 
-			if (0 == --frame->tx.timeout) {
-				nwkTxConfirm(frame, NWK_NO_ACK_STATUS);
-			}
+		if (next && next->tx.timeout) {
+			break;
 		}
 	}
 
-	if (restart) {
-		SYS_TimerStart(timer);
-	}
+	nwkTxDeadlineRestart(NWK_TX_STATE_WAIT_ACK, timer);
 }
 
 /*************************************************************************//**
 *****************************************************************************/
 void nwkTxConfirm(NwkFrame_t *frame, uint8_t status)
 {
-	frame->state = NWK_TX_STATE_CONFIRM;
+	nwkFrameSetState(frame, NWK_TX_STATE_CONFIRM);
 	frame->tx.status = status;
 }
 
@@ -226,7 +410,7 @@ void nwkTxConfirm(NwkFrame_t *frame, uint8_t status)
 *****************************************************************************/
 void nwkTxEncryptConf(NwkFrame_t *frame)
 {
-	frame->state = NWK_TX_STATE_DELAY;
+	nwkFrameSetState(frame, NWK_TX_STATE_DELAY);
 }
 
 #endif
@@ -235,24 +419,345 @@ void nwkTxEncryptConf(NwkFrame_t *frame)
 *****************************************************************************/
 static void nwkTxDelayTimerHandler(SYS_Timer_t *timer)
 {
-	NwkFrame_t *frame = NULL;
-	bool restart = false;
+	NwkFrame_t *frame, *next;
 
-	while (NULL != (frame = nwkFrameNext(frame))) {
-		if (NWK_TX_STATE_WAIT_DELAY == frame->state) {
-			restart = true;
+	for (frame = nwkFrameFirst(NWK_TX_STATE_WAIT_DELAY); frame;
+			frame = next) {
+		next = nwkFrameNext(frame);
 
-			if (0 == --frame->tx.timeout) {
-				frame->state = NWK_TX_STATE_SEND;
-			}
+#ifdef NWK_ENABLE_BROADCAST_SUPPRESSION
+		if (frame->tx.control & NWK_TX_CONTROL_REBROADCAST) {
+			nwkTxUpdateDensity(frame->tx.copies);
+		}
+#endif
+
+		nwkFrameSetState(frame, NWK_TX_STATE_SEND +
+				frame->tx.priority);
+
+		if (next && next->tx.timeout) {
+			break;
+		}
+	}
+
+	nwkTxDeadlineRestart(NWK_TX_STATE_WAIT_DELAY, timer);
+}
+
+/*************************************************************************//**
+*  @brief Puts a @a frame into the deadline queue of the @a state
+*  @param[in] frame Pointer to the frame
+*  @param[in] state Frame state with a deadline queue
+*  @param[in] timer Timer that expires the first frame in the queue
+*  @param[in] timeout Time until the frame deadline in ms
+*
+*  The queue is sorted by deadline and every frame stores its timeout relative
+*  to the previous frame, so that the timer handler only touches the frames
+*  that actually expire. The timeout of the first frame is only updated when
+*  another frame is placed in the queue, the running timer holds the time that
+*  is actually left.
+*****************************************************************************/
+static void nwkTxDeadlineStart(NwkFrame_t *frame, uint8_t state,
+		SYS_Timer_t *timer, uint16_t timeout)
+{
+	NwkFrame_t *next = nwkFrameFirst(state);
+
+	if (next) {
+		next->tx.timeout = SYS_TimerRemaining(timer);
+	}
+
+	for (; next; next = nwkFrameNext(next)) {
+		if (timeout < next->tx.timeout) {
+			next->tx.timeout -= timeout;
+			break;
 		}
+
+		timeout -= next->tx.timeout;
 	}
 
-	if (restart) {
+	frame->tx.timeout = timeout;
+	nwkFrameInsert(frame, state, next);
+
+	if (nwkFrameFirst(state) == frame) {
+		nwkTxDeadlineRestart(state, timer);
+	}
+}
+
+/*************************************************************************//**
+*  @brief Removes a @a frame from its deadline queue before it expires
+*  @param[in] frame Pointer to the frame
+*  @param[in] timer Timer that expires the first frame in the queue
+*
+*  The frame must be moved to a different state right after this call.
+*****************************************************************************/
+static void nwkTxDeadlineStop(NwkFrame_t *frame, SYS_Timer_t *timer)
+{
+	NwkFrame_t *next = nwkFrameNext(frame);
+	bool first = (nwkFrameFirst(frame->state) == frame);
+
+	if (first) {
+		frame->tx.timeout = SYS_TimerRemaining(timer);
+	}
+
+	if (next) {
+		next->tx.timeout += frame->tx.timeout;
+	}
+
+	if (first) {
+		SYS_TimerStop(timer);
+
+		if (next) {
+			timer->interval = next->tx.timeout;
+			SYS_TimerStart(timer);
+		}
+	}
+}
+
+#if defined(NWK_ENABLE_ADAPTIVE_ACK_WAIT) || \
+	defined(NWK_ENABLE_NEIGHBOUR_TABLE)
+
+/*************************************************************************//**
+*  @brief Returns the time left before the @a frame deadline
+*  @param[in] frame Pointer to the frame in a deadline queue
+*  @param[in] timer Timer that expires the first frame in the queue
+*  @return Time in ms
+*****************************************************************************/
+static uint16_t nwkTxDeadlineRemaining(NwkFrame_t *frame,
+		SYS_Timer_t *timer)
+{
+	NwkFrame_t *f = nwkFrameFirst(frame->state);
+	uint16_t timeout = SYS_TimerRemaining(timer);
+
+	while (f != frame) {
+		f = nwkFrameNext(f);
+		timeout += f->tx.timeout;
+	}
+
+	return timeout;
+}
+
+#endif
+
+/*************************************************************************//**
+*  @brief Restarts the @a timer for the first frame in the deadline queue
+*  @param[in] state Frame state with a deadline queue
+*  @param[in] timer Timer that expires the first frame in the queue
+*
+*  The timer stays stopped while the queue is empty.
+*****************************************************************************/
+static void nwkTxDeadlineRestart(uint8_t state, SYS_Timer_t *timer)
+{
+	NwkFrame_t *frame = nwkFrameFirst(state);
+
+	SYS_TimerStop(timer);
+
+	if (frame) {
+		timer->interval = frame->tx.timeout;
 		SYS_TimerStart(timer);
 	}
 }
 
+/*************************************************************************//**
+*  @brief Returns the time to wait for an ACK from the @a dstAddr
+*  @param[in] dstAddr Network address of the destination
+*  @return Time in ms
+*
+*  With the adaptive ACK wait enabled the time is based on the smoothed round
+*  trip time and its variation (RFC 6298), limited to the range from
+*  NWK_ACK_WAIT_MIN_TIME to NWK_ACK_WAIT_TIME. Destinations without an
+*  estimate use NWK_ACK_WAIT_TIME.
+*****************************************************************************/
+uint16_t NWK_AckWaitTime(uint16_t dstAddr)
+{
+#ifdef NWK_ENABLE_ADAPTIVE_ACK_WAIT
+	NWK_RttTableEntry_t *entry = nwkTxRttFind(dstAddr);
+	uint32_t variation, wait;
+
+	if (NULL == entry) {
+		return NWK_ACK_WAIT_TIME;
+	}
+
+	variation = (uint32_t)entry->rttvar * 4;
+	if (variation < SYS_TIMER_INTERVAL) {
+		variation = SYS_TIMER_INTERVAL;
+	}
+
+	wait = entry->srtt + variation;
+
+	if (wait < NWK_ACK_WAIT_MIN_TIME) {
+		return NWK_ACK_WAIT_MIN_TIME;
+	} else if (wait > NWK_ACK_WAIT_TIME) {
+		return NWK_ACK_WAIT_TIME;
+	}
+
+	return wait;
+#else
+	(void)dstAddr;
+	return NWK_ACK_WAIT_TIME;
+#endif
+}
+
+#ifdef NWK_ENABLE_ADAPTIVE_ACK_WAIT
+
+/*************************************************************************//**
+*  @brief Returns the round trip time estimates
+*  @return Pointer to the table of NWK_RTT_TABLE_SIZE entries, unused entries
+*  have the destination address set to @c NWK_BROADCAST_ADDR
+*****************************************************************************/
+NWK_RttTableEntry_t *NWK_RttTable(void)
+{
+	return nwkTxRttTable;
+}
+
+/*************************************************************************//**
+*****************************************************************************/
+static NWK_RttTableEntry_t *nwkTxRttFind(uint16_t dst)
+{
+	if (NWK_BROADCAST_ADDR == dst) {
+		return NULL;
+	}
+
+	for (uint8_t i = 0; i < NWK_RTT_TABLE_SIZE; i++) {
+		if (dst == nwkTxRttTable[i].dstAddr) {
+			return &nwkTxRttTable[i];
+		}
+	}
+
+	return NULL;
+}
+
+/*************************************************************************//**
+*  @brief Updates the round trip time estimate for the @a dst with a new
+*  @a rtt sample in ms
+*****************************************************************************/
+static void nwkTxRttUpdate(uint16_t dst, uint16_t rtt)
+{
+	NWK_RttTableEntry_t *entry;
+	int32_t delta;
+
+	if (NWK_BROADCAST_ADDR == dst) {
+		return;
+	}
+
+	if (NULL == (entry = nwkTxRttFind(dst))) {
+		entry = &nwkTxRttTable[nwkTxRttReplace];
+		nwkTxRttReplace = (nwkTxRttReplace + 1) % NWK_RTT_TABLE_SIZE;
+
+		entry->dstAddr = dst;
+		entry->srtt = rtt;
+		entry->rttvar = rtt / 2;
+		return;
+	}
+
+	delta = (int32_t)rtt - entry->srtt;
+	entry->srtt = (int32_t)entry->srtt + delta / 8;
+
+	if (delta < 0) {
+		delta = -delta;
+	}
+
+	entry->rttvar = (int32_t)entry->rttvar + (delta - entry->rttvar) / 4;
+}
+
+/*************************************************************************//**
+*  @brief Drops the round trip time estimate for the @a dst after an ACK
+*  timeout, so the next frame waits for the full NWK_ACK_WAIT_TIME
+*****************************************************************************/
+static void nwkTxRttRemove(uint16_t dst)
+{
+	NWK_RttTableEntry_t *entry = nwkTxRttFind(dst);
+
+	if (entry) {
+		entry->dstAddr = NWK_BROADCAST_ADDR;
+	}
+}
+
+#endif /* NWK_ENABLE_ADAPTIVE_ACK_WAIT */
+
+/*************************************************************************//**
+*  @brief Schedules retransmission of a failed @a frame
+*  @param[in] frame Pointer to the frame
+*  @return @c true if the frame will be retransmitted
+*
+*  Frames sent with NWK_TX_CONTROL_RETRY are retransmitted up to
+*  NWK_RETRY_AMOUNT times after a missing ACK or a channel access failure.
+*  The frame is sent as it is, already encrypted and with the same network
+*  sequence number, only the MAC header is updated. The delay before each
+*  retransmission is random within the upper half of a window that starts at
+*  NWK_RETRY_BACKOFF_TIME and doubles with every attempt.
+*****************************************************************************/
+static bool nwkTxRetryFrame(NwkFrame_t *frame)
+{
+	NwkFrameHeader_t *header = &frame->header;
+	uint16_t window;
+
+	if (0 == (frame->tx.control & NWK_TX_CONTROL_RETRY) ||
+			frame->tx.attempts > NWK_RETRY_AMOUNT) {
+		return false;
+	}
+
+	if (NWK_NO_ACK_STATUS != frame->tx.status &&
+			NWK_PHY_NO_ACK_STATUS != frame->tx.status &&
+			NWK_PHY_CHANNEL_ACCESS_FAILURE_STATUS !=
+			frame->tx.status) {
+		return false;
+	}
+
+#ifdef NWK_ENABLE_ROUTING
+	/* Route discovery can not be started for an encrypted frame, so the
+	 * next hop is only updated if the route is still known */
+	if (NWK_BROADCAST_ADDR != header->macDstAddr &&
+			0 == header->nwkFcf.linkLocal &&
+			0 == (frame->tx.control & (NWK_TX_CONTROL_DIRECT_LINK |
+			NWK_TX_CONTROL_BROADCAST_PAN_ID))) {
+		uint16_t nextHop = NWK_RouteNextHop(header->nwkDstAddr,
+				header->nwkFcf.multicast);
+
+		if (NWK_ROUTE_UNKNOWN != nextHop) {
+			header->macDstAddr = nextHop;
+		}
+	}
+#endif
+
+	header->macSeq = ++nwkIb.macSeqNum;
+
+	window = NWK_RETRY_BACKOFF_TIME << (frame->tx.attempts - 1);
+	frame->tx.timeout = window / 2 + rand() % (window / 2 + 1);
+	frame->tx.status = NWK_SUCCESS_STATUS;
+	nwkFrameSetState(frame, NWK_TX_STATE_DELAY);
+
+	return true;
+}
+
+/*************************************************************************//**
+*  @brief Selects the next frame to be sent
+*  @return Pointer to the frame or @c NULL if there are no frames to send
+*
+*  High priority frames are always sent first. While low priority frames are
+*  waiting, one of them is sent after every NWK_PRIORITY_WEIGHT normal
+*  priority frames.
+*****************************************************************************/
+static NwkFrame_t *nwkTxNextFrame(void)
+{
+	NwkFrame_t *normal, *low;
+
+	if (nwkFrameFirst(NWK_TX_STATE_SEND + NWK_PRIORITY_HIGH)) {
+		return nwkFrameFirst(NWK_TX_STATE_SEND + NWK_PRIORITY_HIGH);
+	}
+
+	normal = nwkFrameFirst(NWK_TX_STATE_SEND + NWK_PRIORITY_NORMAL);
+	low = nwkFrameFirst(NWK_TX_STATE_SEND + NWK_PRIORITY_LOW);
+
+	if (normal && (NULL == low || nwkTxPriorityCredit > 0)) {
+		if (low) {
+			nwkTxPriorityCredit--;
+		}
+
+		return normal;
+	}
+
+	nwkTxPriorityCredit = NWK_PRIORITY_WEIGHT;
+	return low;
+}
+
 /*************************************************************************//**
 *****************************************************************************/
 static uint8_t nwkTxConvertPhyStatus(uint8_t status)
@@ -272,13 +777,99 @@ static uint8_t nwkTxConvertPhyStatus(uint8_t status)
 	}
 }
 
+#ifdef NWK_ENABLE_HEADER_COMPRESSION
+
+/*************************************************************************//**
+*  @brief Removes the NWK addresses that match the MAC addresses from the
+*  header of the @a frame
+*  @param[in] frame Pointer to the frame
+*  @return Pointer to the frame length field followed by the compressed frame
+*
+*  The header fields in front of the removed addresses are moved towards the
+*  payload, so the frame must be restored with nwkTxRestoreHeader() once the
+*  PHY is done with it.
+*****************************************************************************/
+static uint8_t *nwkTxCompressHeader(NwkFrame_t *frame)
+{
+	NwkFrameHeader_t *header = &frame->header;
+	uint8_t offset = offsetof(NwkFrameHeader_t, nwkDstAddr);
+	uint8_t *data;
+
+	frame->tx.elided = 0;
+
+	if (header->nwkSrcAddr == header->macSrcAddr) {
+		header->nwkFcf.srcElided = 1;
+		offset = offsetof(NwkFrameHeader_t, nwkSrcAddr);
+		frame->tx.elided += sizeof(uint16_t);
+	}
+
+	if (header->nwkDstAddr == header->macDstAddr) {
+		header->nwkFcf.dstElided = 1;
+		frame->tx.elided += sizeof(uint16_t);
+	}
+
+	if (0 == frame->tx.elided) {
+		return &frame->size;
+	}
+
+	data = frame->data + frame->tx.elided;
+	memmove(data, frame->data, offset);
+	data[-1] = frame->size - frame->tx.elided;
+
+	return &data[-1];
+}
+
+/*************************************************************************//**
+*  @brief Restores the header of the @a frame after nwkTxCompressHeader()
+*  @param[in] frame Pointer to the frame
+*****************************************************************************/
+static void nwkTxRestoreHeader(NwkFrame_t *frame)
+{
+	NwkFrameHeader_t *header = &frame->header;
+	NwkFrameHeader_t *moved;
+	uint8_t offset = offsetof(NwkFrameHeader_t, nwkDstAddr);
+
+	if (0 == frame->tx.elided) {
+		return;
+	}
+
+	/* The frame control field is a part of the moved fields */
+	moved = (NwkFrameHeader_t *)(frame->data + frame->tx.elided);
+
+	if (moved->nwkFcf.srcElided) {
+		offset = offsetof(NwkFrameHeader_t, nwkSrcAddr);
+	}
+
+	memmove(frame->data, frame->data + frame->tx.elided, offset);
+
+	if (header->nwkFcf.srcElided) {
+		header->nwkSrcAddr = header->macSrcAddr;
+	}
+
+	if (header->nwkFcf.dstElided) {
+		header->nwkDstAddr = header->macDstAddr;
+	}
+
+	header->nwkFcf.srcElided = 0;
+	header->nwkFcf.dstElided = 0;
+	frame->tx.elided = 0;
+}
+
+#endif /* NWK_ENABLE_HEADER_COMPRESSION */
+
 /*************************************************************************//**
 *****************************************************************************/
 void PHY_DataConf(uint8_t status)
 {
-	nwkTxPhyActiveFrame->tx.status = nwkTxConvertPhyStatus(status);
-	nwkTxPhyActiveFrame->state = NWK_TX_STATE_SENT;
-	nwkTxPhyActiveFrame = NULL;
+	NwkFrame_t *frame = nwkFrameFirst(NWK_TX_STATE_WAIT_CONF);
+
+#ifdef NWK_ENABLE_HEADER_COMPRESSION
+	nwkTxRestoreHeader(frame);
+#endif
+
+	frame->tx.status = nwkTxConvertPhyStatus(status);
+	nwkFrameSetState(frame, NWK_TX_STATE_SENT);
+	nwkTxPhyFrames--;
 	nwkIb.lock--;
 }
 
@@ -287,81 +878,86 @@ void PHY_DataConf(uint8_t status)
 *****************************************************************************/
 void nwkTxTaskHandler(void)
 {
-	NwkFrame_t *frame = NULL;
+	NwkFrame_t *frame, *next;
 
-	while (NULL != (frame = nwkFrameNext(frame))) {
-		switch (frame->state) {
 #ifdef NWK_ENABLE_SECURITY
-		case NWK_TX_STATE_ENCRYPT:
-		{
-			nwkSecurityProcess(frame, true);
-		}
-		break;
+	for (frame = nwkFrameFirst(NWK_TX_STATE_ENCRYPT); frame; frame = next) {
+		next = nwkFrameNext(frame);
+		nwkSecurityProcess(frame, true);
+	}
 #endif
 
-		case NWK_TX_STATE_DELAY:
-		{
-			if (frame->tx.timeout > 0) {
-				frame->state = NWK_TX_STATE_WAIT_DELAY;
-				SYS_TimerStart(&nwkTxDelayTimer);
-			} else {
-				frame->state = NWK_TX_STATE_SEND;
-			}
-		}
-		break;
-
-		case NWK_TX_STATE_SEND:
-		{
-			if (NULL == nwkTxPhyActiveFrame) {
-				nwkTxPhyActiveFrame = frame;
-				frame->state = NWK_TX_STATE_WAIT_CONF;
-				PHY_DataReq(&(frame->size));
-				nwkIb.lock++;
-			}
+	for (frame = nwkFrameFirst(NWK_TX_STATE_DELAY); frame; frame = next) {
+		next = nwkFrameNext(frame);
+
+		if (frame->tx.timeout > 0) {
+			nwkTxDeadlineStart(frame, NWK_TX_STATE_WAIT_DELAY,
+					&nwkTxDelayTimer, frame->tx.timeout);
+		} else {
+			nwkFrameSetState(frame, NWK_TX_STATE_SEND +
+					frame->tx.priority);
 		}
-		break;
+	}
 
-		case NWK_TX_STATE_WAIT_CONF:
-			break;
+	/* With the PHY Tx queue enabled the next frame is queued in the PHY
+	 * while the current one is still in the air */
+	while (nwkTxPhyFrames < NWK_TX_PHY_FRAMES &&
+			NULL != (frame = nwkTxNextFrame())) {
+		nwkFrameSetState(frame, NWK_TX_STATE_WAIT_CONF);
+		frame->tx.attempts++;
+		nwkTxPhyFrames++;
+#ifdef NWK_ENABLE_HEADER_COMPRESSION
+		PHY_DataReq(nwkTxCompressHeader(frame));
+#else
+		PHY_DataReq(&(frame->size));
+#endif
+		nwkIb.lock++;
+	}
+
+	for (frame = nwkFrameFirst(NWK_TX_STATE_SENT); frame; frame = next) {
+		next = nwkFrameNext(frame);
 
-		case NWK_TX_STATE_SENT:
-		{
-			if (NWK_SUCCESS_STATUS == frame->tx.status) {
-				if (frame->header.nwkSrcAddr == nwkIb.addr &&
-						frame->header.nwkFcf.
-						ackRequest) {
-					frame->state = NWK_TX_STATE_WAIT_ACK;
-					frame->tx.timeout = NWK_ACK_WAIT_TIME /
-							NWK_TX_ACK_WAIT_TIMER_INTERVAL
-							+ 1;
-					SYS_TimerStart(&nwkTxAckWaitTimer);
-				} else {
-					frame->state = NWK_TX_STATE_CONFIRM;
-				}
+		if (NWK_SUCCESS_STATUS == frame->tx.status) {
+			if (frame->header.nwkSrcAddr == nwkIb.addr &&
+					frame->header.nwkFcf.ackRequest) {
+				uint16_t wait = NWK_AckWaitTime(
+						frame->header.nwkDstAddr);
+
+#ifdef NWK_ENABLE_ADAPTIVE_ACK_WAIT
+				frame->tx.ackWait = wait;
+#endif
+				nwkTxDeadlineStart(frame, NWK_TX_STATE_WAIT_ACK,
+						&nwkTxAckWaitTimer, wait);
 			} else {
-				frame->state = NWK_TX_STATE_CONFIRM;
+				nwkFrameSetState(frame, NWK_TX_STATE_CONFIRM);
 			}
+		} else {
+			nwkFrameSetState(frame, NWK_TX_STATE_CONFIRM);
 		}
-		break;
+	}
 
-		case NWK_TX_STATE_WAIT_ACK:
-			break;
+	for (frame = nwkFrameFirst(NWK_TX_STATE_CONFIRM); frame; frame = next) {
+		next = nwkFrameNext(frame);
 
-		case NWK_TX_STATE_CONFIRM:
-		{
+#ifdef NWK_ENABLE_NEIGHBOUR_TABLE
+		nwkNeighbourFrameSent(frame);
+#endif
 #ifdef NWK_ENABLE_ROUTING
-			nwkRouteFrameSent(frame);
+		nwkRouteFrameSent(frame);
 #endif
-			if (NULL == frame->tx.confirm) {
-				nwkFrameFree(frame);
-			} else {
-				frame->tx.confirm(frame);
-			}
+		if (nwkTxRetryFrame(frame)) {
+			continue;
 		}
-		break;
 
-		default:
-			break;
+		if ((frame->tx.control & NWK_TX_CONTROL_ROUTING) &&
+				NWK_SUCCESS_STATUS != frame->tx.status) {
+			nwkRxForgetDuplicate(&frame->header);
+		}
+
+		if (NULL == frame->tx.confirm) {
+			nwkFrameFree(frame);
+		} else {
+			frame->tx.confirm(frame);
 		}
 	}
 }
@@ -49,6 +49,7 @@
 
 #define PHY_HAS_RANDOM_NUMBER_GENERATOR
 #define PHY_HAS_AES_MODULE
+#define PHY_HAS_TX_QUEUE
 
 /*- Types ------------------------------------------------------------------*/
 typedef struct PHY_DataInd_t {
@@ -76,6 +77,7 @@ void PHY_Sleep(void);
 void PHY_Wakeup(void);
 void PHY_DataReq(uint8_t *data);
 void PHY_DataConf(uint8_t status);
+uint8_t *PHY_DataIndBuffer(void);
 void PHY_DataInd(PHY_DataInd_t *ind);
 void PHY_TaskHandler(void);
 void PHY_SetIEEEAddr(uint8_t *ieee_addr);
@@ -59,11 +59,13 @@ static uint8_t phyReadRegister(uint8_t reg);
 static void phyWaitState(uint8_t state);
 static void phyTrxSetState(uint8_t state);
 static void phySetRxState(void);
+static void phyTxFrame(uint8_t *data);
 
 /*- Variables --------------------------------------------------------------*/
 static PhyState_t phyState = PHY_STATE_INITIAL;
 static uint8_t phyRxBuffer[128];
 static bool phyRxState;
+static uint8_t *phyTxNextFrame;
 
 /*- Implementations --------------------------------------------------------*/
 
@@ -74,6 +76,7 @@ void PHY_Init(void)
 	trx_spi_init();
 	PhyReset();
 	phyRxState = false;
+	phyTxNextFrame = NULL;
 	phyState = PHY_STATE_IDLE;
 
 	do {phyWriteRegister(TRX_STATE_REG, TRX_CMD_TRX_OFF);
@@ -156,18 +159,39 @@ void PHY_Wakeup(void)
 }
 
 /*************************************************************************//**
+*  @brief Requests a frame transmission
+*  @param[in] data Frame length followed by the frame data
+*
+*  One more frame may be requested while a transmission is in progress. That
+*  frame is queued and sent right after the current one, without leaving the
+*  TX_ARET_ON state. The transceiver sends from its only frame buffer, so the
+*  queued frame is written over SPI once the current one has ended.
+*  PHY_DataConf() is called once for each frame.
 *****************************************************************************/
 void PHY_DataReq(uint8_t *data)
 {
+	if (PHY_STATE_TX_WAIT_END == phyState) {
+		phyTxNextFrame = data;
+		return;
+	}
+
 	phyTrxSetState(TRX_CMD_TX_ARET_ON);
+	phyTxFrame(data);
+}
 
+/*************************************************************************//**
+*****************************************************************************/
+static void phyTxFrame(uint8_t *data)
+{
 	phyReadRegister(IRQ_STATUS_REG);
 
 	/* size of the buffer is sent as first byte of the data
-	 * and data starts from second byte.
+	 * and data starts from second byte. The length includes the CRC,
+	 * the buffer is restored, so the frame may be sent again.
 	 */
 	data[0] += 2;
 	trx_frame_write(data, (data[0] - 1) /* length value*/);
+	data[0] -= 2;
 
 	phyState = PHY_STATE_TX_WAIT_END;
 
@@ -302,6 +326,7 @@ void PHY_TaskHandler(void)
 	if (phyReadRegister(IRQ_STATUS_REG) & (1 << TRX_END)) {
 		if (PHY_STATE_IDLE == phyState) {
 			PHY_DataInd_t ind;
+			uint8_t *buffer;
 			uint8_t size;
 			int8_t rssi;
 
@@ -309,12 +334,19 @@ void PHY_TaskHandler(void)
 
 			trx_frame_read(&size, 1);
 
-			trx_frame_read(phyRxBuffer, size + 2);
+			/* Read the frame straight into the upper layer buffer
+			 * if one is available */
+			buffer = PHY_DataIndBuffer();
+			if (NULL == buffer) {
+				buffer = phyRxBuffer;
+			}
+
+			trx_frame_read(buffer, size + 2);
 
-			ind.data = phyRxBuffer + 1;
+			ind.data = buffer + 1;
 
 			ind.size = size - PHY_CRC_SIZE;
-			ind.lqi  = phyRxBuffer[size + 1];
+			ind.lqi  = buffer[size + 1];
 			ind.rssi = rssi + PHY_RSSI_BASE_VAL;
 			PHY_DataInd(&ind);
 
@@ -335,8 +367,17 @@ void PHY_TaskHandler(void)
 				status = PHY_STATUS_ERROR;
 			}
 
-			phySetRxState();
-			phyState = PHY_STATE_IDLE;
+			if (phyTxNextFrame) {
+				/* The transceiver is back in TX_ARET_ON, so the
+				 * queued frame is sent without a state change */
+				uint8_t *data = phyTxNextFrame;
+
+				phyTxNextFrame = NULL;
+				phyTxFrame(data);
+			} else {
+				phySetRxState();
+				phyState = PHY_STATE_IDLE;
+			}
 
 			PHY_DataConf(status);
 		}
@@ -76,6 +76,7 @@ void PHY_Sleep(void);
 void PHY_Wakeup(void);
 void PHY_DataReq(uint8_t *data);
 void PHY_DataConf(uint8_t status);
+uint8_t *PHY_DataIndBuffer(void);
 void PHY_DataInd(PHY_DataInd_t *ind);
 void PHY_TaskHandler(void);
 void PHY_SetIEEEAddr(uint8_t *ieee_addr);
@@ -35,6 +35,7 @@
 #ifdef PHY_ATMEGARFR2
 #define IRQ_CLEAR_VALUE       0xff
 /*- Includes ---------------------------------------------------------------*/
+#include <stddef.h>
 #include "phy.h"
 #include "delay.h"
 #include "sal.h"
@@ -296,14 +297,25 @@ void PHY_TaskHandler(void)
 	if (IRQ_STATUS_REG_s.rxEnd) {
 		PHY_DataInd_t ind;
 		uint8_t size = TST_RX_LENGTH_REG;
+		uint8_t *data;
+
+		/* Copy the frame straight into the upper layer buffer
+		 * if one is available */
+		data = PHY_DataIndBuffer();
+		if (NULL == data) {
+			data = phyRxBuffer;
+		} else {
+			data[0] = size;
+			data++;
+		}
 
 		for (uint8_t i = 0; i < size + 1 /*lqi*/; i++) {
-			phyRxBuffer[i] = TRX_FRAME_BUFFER(i);
+			data[i] = TRX_FRAME_BUFFER(i);
 		}
 
-		ind.data = phyRxBuffer;
+		ind.data = data;
 		ind.size = size - PHY_CRC_SIZE;
-		ind.lqi  = phyRxBuffer[size];
+		ind.lqi  = data[size];
 		ind.rssi = (int8_t)PHY_ED_LEVEL_REG + PHY_RSSI_BASE_VAL;
 		PHY_DataInd(&ind);
 
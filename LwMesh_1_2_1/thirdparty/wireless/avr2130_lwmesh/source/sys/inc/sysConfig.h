@@ -49,6 +49,22 @@
 #define NWK_BUFFERS_AMOUNT                       5
 #endif
 
+#ifndef NWK_SMALL_BUFFERS_AMOUNT
+#define NWK_SMALL_BUFFERS_AMOUNT                 0
+#endif
+
+#ifndef NWK_COMMAND_BUFFERS_RESERVED
+#define NWK_COMMAND_BUFFERS_RESERVED             0
+#endif
+
+#ifndef NWK_RX_BUFFERS_RESERVED
+#define NWK_RX_BUFFERS_RESERVED                  0
+#endif
+
+#ifndef NWK_DATA_REQ_BUDGET
+#define NWK_DATA_REQ_BUDGET                      4
+#endif
+
 #ifndef NWK_DUPLICATE_REJECTION_TABLE_SIZE
 #define NWK_DUPLICATE_REJECTION_TABLE_SIZE       10
 #endif
@@ -65,10 +81,98 @@
 #define NWK_ROUTE_DEFAULT_SCORE                  3
 #endif
 
+#ifndef NWK_ROUTE_ALTERNATES_AMOUNT
+#define NWK_ROUTE_ALTERNATES_AMOUNT              2
+#endif
+
+#ifndef NWK_ROUTE_BALANCE_MARGIN
+#define NWK_ROUTE_BALANCE_MARGIN                 8
+#endif
+
+#ifndef NWK_NEIGHBOUR_TABLE_SIZE
+#define NWK_NEIGHBOUR_TABLE_SIZE                 8
+#endif
+
+#ifndef NWK_NEIGHBOUR_ETX_WINDOW
+#define NWK_NEIGHBOUR_ETX_WINDOW                 4
+#endif
+
+#ifndef NWK_ROUTE_ETX_HYSTERESIS
+#define NWK_ROUTE_ETX_HYSTERESIS                 8 /* 1/16 transmissions */
+#endif
+
 #ifndef NWK_ACK_WAIT_TIME
 #define NWK_ACK_WAIT_TIME                        1000 /* ms */
 #endif
 
+#ifndef NWK_ACK_WAIT_MIN_TIME
+#define NWK_ACK_WAIT_MIN_TIME                    50 /* ms */
+#endif
+
+#ifndef NWK_RTT_TABLE_SIZE
+#define NWK_RTT_TABLE_SIZE                       5
+#endif
+
+#ifndef NWK_DELAYED_ACK_TIME
+#define NWK_DELAYED_ACK_TIME                     20 /* ms */
+#endif
+
+#ifndef NWK_DELAYED_ACK_AMOUNT
+#define NWK_DELAYED_ACK_AMOUNT                   8
+#endif
+
+#ifndef NWK_RETRY_AMOUNT
+#define NWK_RETRY_AMOUNT                         3
+#endif
+
+#ifndef NWK_RETRY_BACKOFF_TIME
+#define NWK_RETRY_BACKOFF_TIME                   100 /* ms */
+#endif
+
+#ifndef NWK_PRIORITY_WEIGHT
+#define NWK_PRIORITY_WEIGHT                      4
+#endif
+
+#ifndef NWK_BROADCAST_SUPPRESSION_THRESHOLD
+#define NWK_BROADCAST_SUPPRESSION_THRESHOLD      3
+#endif
+
+#ifndef NWK_AGGREGATION_HOLD_TIME
+#define NWK_AGGREGATION_HOLD_TIME                50 /* ms */
+#endif
+
+#ifndef NWK_FRAG_WINDOW
+#define NWK_FRAG_WINDOW                          4
+#endif
+
+#ifndef NWK_FRAG_ACK_WAIT_TIME
+#define NWK_FRAG_ACK_WAIT_TIME                   500 /* ms */
+#endif
+
+#ifndef NWK_FRAG_RETRY_AMOUNT
+#define NWK_FRAG_RETRY_AMOUNT                    3
+#endif
+
+#ifndef NWK_FRAG_RX_TIMEOUT
+#define NWK_FRAG_RX_TIMEOUT                      3000 /* ms */
+#endif
+
+#ifndef NWK_STREAM_WINDOW
+#define NWK_STREAM_WINDOW                        4
+#endif
+
+#ifndef NWK_STREAM_PEERS_AMOUNT
+#define NWK_STREAM_PEERS_AMOUNT                  2
+#endif
+
+#ifndef NWK_STREAM_ACK_WAIT_TIME
+#define NWK_STREAM_ACK_WAIT_TIME                 500 /* ms */
+#endif
+
+#ifndef NWK_STREAM_RETRY_AMOUNT
+#define NWK_STREAM_RETRY_AMOUNT                  3
+#endif
+
 #ifndef NWK_GROUPS_AMOUNT
 #define NWK_GROUPS_AMOUNT                        10
 #endif
@@ -81,16 +185,131 @@
 #define NWK_ROUTE_DISCOVERY_TIMEOUT              1000 /* ms */
 #endif
 
+#ifndef NWK_ROUTE_DISCOVERY_TTL_START
+#define NWK_ROUTE_DISCOVERY_TTL_START            2
+#endif
+
+#ifndef NWK_ROUTE_DISCOVERY_TTL_INCREMENT
+#define NWK_ROUTE_DISCOVERY_TTL_INCREMENT        2
+#endif
+
+#ifndef NWK_ROUTE_DISCOVERY_TTL_THRESHOLD
+#define NWK_ROUTE_DISCOVERY_TTL_THRESHOLD        6
+#endif
+
+#ifndef NWK_ROUTE_DISCOVERY_RING_TIMEOUT
+#define NWK_ROUTE_DISCOVERY_RING_TIMEOUT         100 /* ms per hop */
+#endif
+
+#ifndef NWK_ROUTE_DISCOVERY_FRESH_TIME
+#define NWK_ROUTE_DISCOVERY_FRESH_TIME           10000 /* ms */
+#endif
+
 /* #define NWK_ENABLE_ROUTING */
 /* #define NWK_ENABLE_SECURITY */
 /* #define NWK_ENABLE_MULTICAST */
 /* #define NWK_ENABLE_ROUTE_DISCOVERY */
+/* #define NWK_ENABLE_EXPANDING_RING */
 /* #define NWK_ENABLE_SECURE_COMMANDS */
+/* #define NWK_ENABLE_PHY_TX_QUEUE */
+/* #define NWK_ENABLE_ADAPTIVE_ACK_WAIT */
+/* #define NWK_ENABLE_BROADCAST_SUPPRESSION */
+/* #define NWK_ENABLE_AGGREGATION */
+/* #define NWK_ENABLE_FRAGMENTATION */
+/* #define NWK_ENABLE_HEADER_COMPRESSION */
+/* #define NWK_ENABLE_STREAM */
+/* #define NWK_ENABLE_DELAYED_ACK */
+/* #define NWK_ENABLE_NEIGHBOUR_TABLE */
+/* #define NWK_ENABLE_ETX */
+/* #define NWK_ENABLE_MULTIPATH */
+/* #define NWK_ENABLE_MULTIPATH_BALANCING */
 
 #ifndef SYS_SECURITY_MODE
 #define SYS_SECURITY_MODE                        1
 #endif
 
 /*- Sanity checks ----------------------------------------------------------*/
+#if (NWK_COMMAND_BUFFERS_RESERVED + NWK_RX_BUFFERS_RESERVED) >= \
+	NWK_BUFFERS_AMOUNT
+  #error Reserved buffers leave no buffers for data frames
+#endif
+
+#if NWK_DATA_REQ_BUDGET < 1
+  #error NWK_DATA_REQ_BUDGET must be at least 1
+#endif
+
+#if NWK_ROUTE_TABLE_SIZE < 1 || NWK_ROUTE_TABLE_SIZE > 0x7fff
+  #error NWK_ROUTE_TABLE_SIZE must be between 1 and 32767
+#endif
+
+#if NWK_ROUTE_ALTERNATES_AMOUNT < 1 || NWK_ROUTE_ALTERNATES_AMOUNT > 8
+  #error NWK_ROUTE_ALTERNATES_AMOUNT must be between 1 and 8
+#endif
+
+#if defined(NWK_ENABLE_MULTIPATH_BALANCING) && !defined(NWK_ENABLE_MULTIPATH)
+  #error NWK_ENABLE_MULTIPATH_BALANCING requires NWK_ENABLE_MULTIPATH
+#endif
+
+#if NWK_NEIGHBOUR_TABLE_SIZE < 1 || NWK_NEIGHBOUR_TABLE_SIZE > 127
+  #error NWK_NEIGHBOUR_TABLE_SIZE must be between 1 and 127
+#endif
+
+#if NWK_NEIGHBOUR_ETX_WINDOW < 1 || NWK_NEIGHBOUR_ETX_WINDOW > 15
+  #error NWK_NEIGHBOUR_ETX_WINDOW must be between 1 and 15
+#endif
+
+#if defined(NWK_ENABLE_ETX) && !defined(NWK_ENABLE_NEIGHBOUR_TABLE)
+  #error NWK_ENABLE_ETX requires NWK_ENABLE_NEIGHBOUR_TABLE
+#endif
+
+#if defined(NWK_ENABLE_EXPANDING_RING) && \
+	!defined(NWK_ENABLE_ROUTE_DISCOVERY)
+  #error NWK_ENABLE_EXPANDING_RING requires NWK_ENABLE_ROUTE_DISCOVERY
+#endif
+
+#if NWK_ROUTE_DISCOVERY_TTL_START < 1 || \
+	NWK_ROUTE_DISCOVERY_TTL_START > NWK_ROUTE_DISCOVERY_TTL_THRESHOLD
+  #error NWK_ROUTE_DISCOVERY_TTL_START must be between 1 and the threshold
+#endif
+
+#if NWK_ROUTE_DISCOVERY_TTL_INCREMENT < 1 || \
+	NWK_ROUTE_DISCOVERY_TTL_THRESHOLD > 127
+  #error Invalid expanding ring TTL increment or threshold
+#endif
+
+#if NWK_ROUTE_DISCOVERY_TTL_THRESHOLD * NWK_ROUTE_DISCOVERY_RING_TIMEOUT > \
+	0xffff
+  #error Expanding ring timeouts must not exceed 65535 ms
+#endif
+
+#if NWK_ACK_WAIT_TIME > 0xffff
+  #error NWK_ACK_WAIT_TIME must not exceed 65535 ms
+#endif
+
+#if (NWK_RETRY_BACKOFF_TIME << NWK_RETRY_AMOUNT) > 0xffff
+  #error Retry backoff time must not exceed 65535 ms
+#endif
+
+#if NWK_ACK_WAIT_MIN_TIME > NWK_ACK_WAIT_TIME
+  #error NWK_ACK_WAIT_MIN_TIME must not exceed NWK_ACK_WAIT_TIME
+#endif
+
+#if defined(NWK_ENABLE_DELAYED_ACK) && \
+	NWK_DELAYED_ACK_TIME >= NWK_ACK_WAIT_MIN_TIME
+  #error NWK_DELAYED_ACK_TIME must be less than NWK_ACK_WAIT_MIN_TIME
+#endif
+
+#if NWK_DELAYED_ACK_AMOUNT < 1
+  #error NWK_DELAYED_ACK_AMOUNT must be at least 1
+#endif
+
+#if NWK_BROADCAST_SUPPRESSION_THRESHOLD < 1
+  #error NWK_BROADCAST_SUPPRESSION_THRESHOLD must be at least 1
+#endif
+
+#if NWK_STREAM_WINDOW != 1 && NWK_STREAM_WINDOW != 2 && \
+	NWK_STREAM_WINDOW != 4 && NWK_STREAM_WINDOW != 8
+  #error NWK_STREAM_WINDOW must be 1, 2, 4 or 8
+#endif
 
 #endif /* _SYS_CONFIG_H_ */
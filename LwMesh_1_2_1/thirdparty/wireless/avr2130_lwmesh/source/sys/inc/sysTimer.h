@@ -76,6 +76,8 @@ void SYS_TimerInit(void);
 void SYS_TimerStart(SYS_Timer_t *timer);
 void SYS_TimerStop(SYS_Timer_t *timer);
 bool SYS_TimerStarted(SYS_Timer_t *timer);
+uint32_t SYS_TimerRemaining(SYS_Timer_t *timer);
+uint32_t SYS_TimerTime(void);
 void SYS_TimerTaskHandler(void);
 void SYS_HwExpiry_Cb(void);
 
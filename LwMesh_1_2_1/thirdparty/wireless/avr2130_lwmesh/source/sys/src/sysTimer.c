@@ -52,6 +52,7 @@ static void placeTimer(SYS_Timer_t *timer);
 
 /*- Variables --------------------------------------------------------------*/
 static SYS_Timer_t *timers;
+static uint32_t sysTimerTime;
 
 /*- Implementations --------------------------------------------------------*/
 
@@ -64,6 +65,7 @@ void SYS_TimerInit(void)
 	common_tc_init();
 	common_tc_delay(SYS_TIMER_INTERVAL * MS);
 	timers = NULL;
+	sysTimerTime = 0;
 }
 
 /*************************************************************************//**
@@ -112,6 +114,34 @@ bool SYS_TimerStarted(SYS_Timer_t *timer)
 	return false;
 }
 
+/*************************************************************************//**
+*  @brief Returns the time left before the @a timer expires
+*  @param[in] timer Pointer to the timer
+*  @return Time in ms or 0 if the timer is not started
+*****************************************************************************/
+uint32_t SYS_TimerRemaining(SYS_Timer_t *timer)
+{
+	uint32_t timeout = 0;
+
+	for (SYS_Timer_t *t = timers; t; t = t->next) {
+		timeout += t->timeout;
+
+		if (t == timer) {
+			return timeout;
+		}
+	}
+	return 0;
+}
+
+/*************************************************************************//**
+*  @brief Returns the time elapsed since the timer service was initialized
+*  @return Time in ms, wraps around after 2^32 ms
+*****************************************************************************/
+uint32_t SYS_TimerTime(void)
+{
+	return sysTimerTime;
+}
+
 /*************************************************************************//**
 *****************************************************************************/
 void SYS_TimerTaskHandler(void)
@@ -132,6 +162,7 @@ void SYS_TimerTaskHandler(void)
 	cpu_irq_restore(flags);
 
 	elapsed = cnt * SYS_TIMER_INTERVAL;
+	sysTimerTime += elapsed;
 
 	while (timers && (timers->timeout <= elapsed)) {
 		SYS_Timer_t *timer = timers;